@@ -1,16 +1,71 @@
 #version 330 core
+#include "terrain_common.glsl"
 
 out vec4 frag_color;
 
 in vec2 vert_tex_coord;
+in float vert_light;
+#ifdef FOG
+in float vert_fog;
+#endif
+#ifdef TRANSLUCENT
+flat in uint vert_block;
+#endif
+#ifdef SHADOWS
+in vec3 vert_world;
+in float vert_depth;
+flat in vec3 vert_normal;
+#endif
 
+// texture1 and trans are only used by the translucent pass: glass is
+// drawn from texture1 and water has opacity trans
 uniform sampler2D texture0;
 uniform sampler2D texture1;
 uniform float trans;
 
+// Colour added per fragment in overdraw mode; white after about ten
+const vec3 overdraw_step = vec3(0.1f, 0.05f, 0.025f);
+
+#ifdef TRANSLUCENT
+// Block ids, as in chunk.hpp
+const uint block_water = 3u;
+
+const vec3 water_color = vec3(0.15f, 0.35f, 0.7f);
+const vec3 glass_color = vec3(0.8f, 0.9f, 0.95f);
+const float glass_alpha = 0.2f;
+#endif
+
 void main()
 {
-    frag_color = mix(texture(texture0, vert_tex_coord),
-                     texture(texture1, vert_tex_coord),
-                     trans);
+#if defined(DEPTH_ONLY) || defined(SHADOW_CASTER)
+    frag_color = vec4(0.0f);
+    return;
+#elif defined(OVERDRAW)
+    frag_color = vec4(overdraw_step, 1.0f);
+    return;
+#endif
+
+#ifdef TRANSLUCENT
+    if (vert_block == block_water) {
+        // Keep a little of the terrain texture's grain in the water
+        vec3 grain = texture(texture0, vert_tex_coord).rgb;
+        float shade = 0.6f + 0.4f * dot(grain, vec3(0.299f, 0.587f, 0.114f));
+        frag_color = vec4(water_color * shade, trans);
+    } else {
+        // A faint pane, with texture1 painted on where it is opaque
+        vec4 picture = texture(texture1, vert_tex_coord);
+        frag_color = vec4(mix(glass_color, picture.rgb, picture.a),
+                          max(picture.a, glass_alpha));
+    }
+#else
+    frag_color = texture(texture0, vert_tex_coord);
+#endif
+    frag_color.rgb *= vert_light;
+#ifdef SHADOWS
+    float sun = sun_visibility(vert_world, vert_normal, vert_depth);
+    frag_color.rgb *= mix(1.0f - shadow_strength, 1.0f, sun);
+#endif
+#ifdef FOG
+    frag_color.rgb = mix(frag_color.rgb, fog_color, vert_fog);
+#endif
 }
@@ -1,16 +1,91 @@
 #version 330 core
-
-layout (location = 0) in vec3 position;
-layout (location = 1) in vec2 tex_coord;
+#include "terrain_common.glsl"
 
 out vec2 vert_tex_coord;
+out float vert_light;
+#ifdef FOG
+out float vert_fog;
+#endif
+#ifdef TRANSLUCENT
+flat out uint vert_block;
+#endif
+#ifdef SHADOWS
+out vec3 vert_world;
+out float vert_depth;
+flat out vec3 vert_normal;
+#endif
+
+// One record per face (see mesher.hpp), fetched by gl_VertexID / 4
+uniform usamplerBuffer faces;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// The depth pre-pass and the shaded pass are different programs; both
+// must come up with exactly the same depth
+invariant gl_Position;
+
+// Corner positions and texture coordinates of each face, in face order
+// (-x, +x, -y, +y, -z, +z); must match cube.cpp
+const vec3 corner_position[24] = vec3[](
+    vec3(0, 1, 1), vec3(0, 1, 0), vec3(0, 0, 0), vec3(0, 0, 1),
+    vec3(1, 1, 1), vec3(1, 1, 0), vec3(1, 0, 0), vec3(1, 0, 1),
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1),
+    vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 1, 1), vec3(0, 1, 1),
+    vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0),
+    vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1)
+);
+
+// Outward normal of each face, in the same order
+const vec3 face_normal[6] = vec3[](
+    vec3(-1, 0, 0), vec3(1, 0, 0),
+    vec3(0, -1, 0), vec3(0, 1, 0),
+    vec3(0, 0, -1), vec3(0, 0, 1)
+);
+
+const vec2 corner_tex_coord[24] = vec2[](
+    vec2(1, 0), vec2(1, 1), vec2(0, 1), vec2(0, 0),
+    vec2(1, 0), vec2(1, 1), vec2(0, 1), vec2(0, 0),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0),
+    vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1),
+    vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1)
+);
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0f);
-    vert_tex_coord = tex_coord;
+    uvec2 record = texelFetch(faces, gl_VertexID / 4).xy;
+
+    // The flip bit starts the quad at corner 1, moving the diagonal
+    uint flip = (record.x >> 15u) & 1u;
+    int corner = int((uint(gl_VertexID) + flip) & 3u);
+    int face = int((record.x >> 12u) & 7u);
+
+    vec3 block = vec3(record.x & 15u, (record.x >> 4u) & 15u, (record.x >> 8u) & 15u);
+    vec3 position = block + corner_position[face * 4 + corner];
+
+    vec4 world_position = model * vec4(position, 1.0f);
+    vec4 view_position = view * world_position;
+    gl_Position = projection * view_position;
+    vert_tex_coord = corner_tex_coord[face * 4 + corner];
+
+    // Sky (low nibble) and block (high nibble) light levels
+    uint light = (record.y >> (8u * uint(corner))) & 255u;
+    vert_light = light_curve(float(max(light & 15u, light >> 4u)) / 15.0f);
+#ifdef AO
+    float ao = float((record.x >> (16u + 2u * uint(corner))) & 3u);
+    vert_light *= ao_factor(ao);
+#endif
+#ifdef FOG
+    vert_fog = fog_factor(length(view_position.xyz));
+#endif
+#ifdef TRANSLUCENT
+    vert_block = record.x >> 24u;
+#endif
+#ifdef SHADOWS
+    vert_world = world_position.xyz;
+    vert_depth = -view_position.z;
+    vert_normal = face_normal[face];
+#endif
 }
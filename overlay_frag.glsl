@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec4 frag_color;
+
+in vec2 vert_tex_coord;
+in vec4 vert_color;
+
+uniform sampler2D font;
+
+void main()
+{
+    float coverage = texture(font, vert_tex_coord).r;
+    frag_color = vec4(vert_color.rgb, vert_color.a * coverage);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 tex_coord;
+layout (location = 2) in vec4 color;
+
+out vec2 vert_tex_coord;
+out vec4 vert_color;
+
+// Window size in pixels; positions are pixels from the top left
+uniform vec2 screen_size;
+
+void main()
+{
+    vec2 ndc = position / screen_size * 2.0f - 1.0f;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0f, 1.0f);
+    vert_tex_coord = tex_coord;
+    vert_color = color;
+}
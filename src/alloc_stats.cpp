@@ -0,0 +1,143 @@
+// Module Header
+#include "alloc_stats.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// C++ Standard Headers
+#include <new>
+
+using namespace std;
+
+#ifdef VOXEL_ALLOC_STATS
+
+// Plain integer, so it needs no construction before the first new
+static thread_local uint64_t s_allocations = 0;
+
+static void *counted_alloc(size_t size)
+{
+    s_allocations++;
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void *counted_aligned_alloc(size_t size, align_val_t align)
+{
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size_t alignment = static_cast<size_t>(align);
+    size_t rounded = (size + alignment - 1) / alignment * alignment;
+
+    s_allocations++;
+    return aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+}
+
+void *operator new(size_t size)
+{
+    void *p = counted_alloc(size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t&) noexcept
+{
+    return counted_alloc(size);
+}
+
+void *operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return counted_alloc(size);
+}
+
+void *operator new(size_t size, align_val_t align)
+{
+    void *p = counted_aligned_alloc(size, align);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size, align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t, align_val_t) noexcept
+{
+    free(p);
+}
+
+namespace alloc_stats {
+
+bool enabled()
+{
+    return true;
+}
+
+uint64_t thread_allocations()
+{
+    return s_allocations;
+}
+
+} // namespace alloc_stats
+
+#else
+
+namespace alloc_stats {
+
+bool enabled()
+{
+    return false;
+}
+
+uint64_t thread_allocations()
+{
+    return 0;
+}
+
+} // namespace alloc_stats
+
+#endif // VOXEL_ALLOC_STATS
@@ -0,0 +1,24 @@
+#ifndef ALLOC_STATS_HPP
+#define ALLOC_STATS_HPP
+
+// C Standard Headers
+#include <cstdint>
+
+/**
+ *  Counts heap allocations made through operator new, per thread
+ *
+ *  With VOXEL_ALLOC_STATS defined the global operator new and delete are
+ *  replaced by versions that bump a counter for the calling thread and
+ *  then use malloc and free, so a stretch of code can be checked for
+ *  allocations by comparing thread_allocations() before and after.
+ *  Direct malloc calls (SDL, the GL driver) are not seen.  Without
+ *  VOXEL_ALLOC_STATS nothing is replaced and the count stays zero.
+ */
+namespace alloc_stats {
+
+bool enabled();
+uint64_t thread_allocations();
+
+} // namespace alloc_stats
+
+#endif // ALLOC_STATS_HPP
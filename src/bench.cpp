@@ -0,0 +1,213 @@
+// Module Header
+#include "bench.hpp"
+
+// Local Headers
+#include "chunk.hpp"
+#include "mesher.hpp"
+#include "raycast.hpp"
+#include "world.hpp"
+
+// External Headers
+#include <glm/glm.hpp>
+
+// C Standard Headers
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+static const int s_terrain_size = 256;
+static const int s_terrain_height = 64;
+static const int s_ray_count = 1000000;
+static const float s_ray_length = 128.0f;
+static const int s_mesh_passes = 5;
+
+typedef chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point start)
+{
+    return chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+// Rolling hills with some open sky above, so rays see a mix of empty
+// chunks, long air runs and early hits.
+static void generate_terrain(world& w)
+{
+    for (int z = 0; z < s_terrain_size; z++) {
+        for (int x = 0; x < s_terrain_size; x++) {
+            float h = 24.0f + 10.0f * sinf(x * 0.05f) * cosf(z * 0.07f)
+                            + 4.0f * sinf((x + z) * 0.21f);
+            for (int y = 0; y < (int)h && y < s_terrain_height; y++) {
+                w.set_block(x, y, z, block::crate);
+            }
+        }
+    }
+}
+
+struct ray {
+    glm::vec3 origin;
+    glm::vec3 dir;
+};
+
+// Random origins and directions: worst case for packet coherence
+static void make_random_rays(vector<ray>& rays, int count)
+{
+    mt19937 rng(1234);
+    uniform_real_distribution<float> pos(0.0f, (float)s_terrain_size);
+    uniform_real_distribution<float> height(30.0f, 60.0f);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    rays.resize(count);
+    for (ray& r : rays) {
+        r.origin = glm::vec3(pos(rng), height(rng), pos(rng));
+        glm::vec3 d(unit(rng), unit(rng) - 0.5f, unit(rng));
+        r.dir = glm::normalize(d);
+    }
+}
+
+// A screen's worth of rays fanning out from a few eye points, the way
+// picking, shadow or visibility queries come in practice.
+static void make_coherent_rays(vector<ray>& rays, int count)
+{
+    const int side = 250;
+    const glm::vec3 eyes[] = {
+        glm::vec3(40.0f, 50.0f, 40.0f),
+        glm::vec3(200.0f, 45.0f, 60.0f),
+        glm::vec3(128.0f, 55.0f, 220.0f),
+        glm::vec3(64.0f, 40.0f, 180.0f)
+    };
+
+    rays.clear();
+    for (int i = 0; (int)rays.size() < count; i++) {
+        const glm::vec3& eye = eyes[i % 4];
+        for (int v = 0; v < side && (int)rays.size() < count; v++) {
+            for (int u = 0; u < side && (int)rays.size() < count; u++) {
+                glm::vec3 d(1.0f, -0.6f + 0.8f * v / side, -0.5f + 1.0f * u / side);
+                rays.push_back(ray{eye, glm::normalize(d)});
+            }
+        }
+    }
+}
+
+static void bench_raycast(const world& w, const vector<ray>& rays, const char *label)
+{
+    raycast_hit hit;
+    uint64_t hits = 0;
+
+    bench_clock::time_point start = bench_clock::now();
+    for (const ray& r : rays) {
+        if (raycast(w, r.origin, r.dir, s_ray_length, hit)) {
+            hits++;
+        }
+    }
+    double single = seconds_since(start);
+
+    vector<glm::vec3> origins;
+    vector<glm::vec3> dirs;
+    for (const ray& r : rays) {
+        origins.push_back(r.origin);
+        dirs.push_back(r.dir);
+    }
+
+    raycast_hits packet_hits;
+    start = bench_clock::now();
+    raycast_batch(w, origins.data(), dirs.data(), rays.size(), s_ray_length, packet_hits);
+    double packet = seconds_since(start);
+
+    uint64_t batch_hits = 0;
+    for (size_t i = 0; i < packet_hits.size(); i++) {
+        batch_hits += packet_hits.hit[i];
+    }
+
+    printf("raycast (%s): %zu rays, %llu hits\n",
+           label, rays.size(), (unsigned long long)hits);
+    printf("  single: %.3f s, %.2f Mrays/s\n", single, rays.size() / single / 1e6);
+    printf("  packet: %.3f s, %.2f Mrays/s (x%d, %.2fx)%s\n",
+           packet,
+           rays.size() / packet / 1e6,
+           raycast_packet_width,
+           single / packet,
+           batch_hits == hits ? "" : " MISMATCH");
+}
+
+// Meshes every section of the world, returning the face words produced so
+// the two culling modes can be checked against each other
+static double time_meshing(const world& w,
+                           const vector<section_coord>& sections,
+                           mesher::culling mode,
+                           vector<uint32_t>& all_faces)
+{
+    unique_ptr<mesher> m = make_unique<mesher>(mode);
+    vector<uint32_t> faces;
+    vector<uint32_t> translucent_faces;
+
+    all_faces.clear();
+    for (const section_coord& coord : sections) {
+        m->mesh(w, coord, faces, translucent_faces);
+        all_faces.insert(all_faces.end(), faces.begin(), faces.end());
+        all_faces.insert(all_faces.end(), translucent_faces.begin(), translucent_faces.end());
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+    for (int pass = 0; pass < s_mesh_passes; pass++) {
+        for (const section_coord& coord : sections) {
+            m->mesh(w, coord, faces, translucent_faces);
+        }
+    }
+    return seconds_since(start) / s_mesh_passes;
+}
+
+static void bench_meshing(world& w)
+{
+    vector<section_coord> sections;
+    w.take_dirty_sections(sections);
+
+    vector<uint32_t> naive_faces;
+    vector<uint32_t> bitmask_faces;
+    double naive = time_meshing(w, sections, mesher::culling::naive, naive_faces);
+    double bitmask = time_meshing(w, sections, mesher::culling::bitmask, bitmask_faces);
+
+#if defined(__AVX2__)
+    const char *kernel = "avx2";
+#elif defined(__SSE2__)
+    const char *kernel = "sse2";
+#else
+    const char *kernel = "scalar";
+#endif
+
+    double per_chunk = chunk::sections * chunk::sections * chunk::sections;
+    printf("meshing: %zu sections, %zu faces\n",
+           sections.size(), bitmask_faces.size() / mesher::face_words);
+    printf("  naive:   %.3f s, %.0f chunks/s\n", naive, sections.size() / per_chunk / naive);
+    printf("  bitmask: %.3f s, %.0f chunks/s (%s, %.2fx)%s\n",
+           bitmask,
+           sections.size() / per_chunk / bitmask,
+           kernel,
+           naive / bitmask,
+           bitmask_faces == naive_faces ? "" : " MISMATCH");
+}
+
+int run_benchmarks()
+{
+    world w;
+    generate_terrain(w);
+    printf("bench world: %zu chunks\n", w.chunk_count());
+
+    vector<ray> rays;
+    make_random_rays(rays, s_ray_count);
+    bench_raycast(w, rays, "random");
+
+    make_coherent_rays(rays, s_ray_count);
+    bench_raycast(w, rays, "coherent");
+
+    bench_meshing(w);
+
+    return 0;
+}
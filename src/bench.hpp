@@ -0,0 +1,13 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+/**
+ *  Headless micro-benchmarks for the world, meshing and query code
+ *
+ *  Run with `./test --bench`; no window or GL context is created.
+ *  Results are printed to stdout.  GPU timings of the shadow passes need
+ *  a window and come from `./test --bench-shadows` instead (see main.cpp).
+ */
+int run_benchmarks();
+
+#endif // BENCH_HPP
@@ -8,8 +8,12 @@
 camera::camera() :
     m_pitch(0),
     m_yaw(270),
-    m_trans_speed(0.03),
-    m_rot_speed(0.05),
+    m_prev_pitch(0),
+    m_prev_yaw(270),
+    m_prev_pos(0.0f, 0.0f, 3.0f),
+    m_trans_speed(10.0f),
+    m_rot_speed(90.0f),
+    m_velocity(0.0f),
     m_pos(0.0f, 0.0f, 3.0f),
     m_up(0.0f, 1.0f, 0.0f),
     m_front(0.0f, 0.0f, -1.0f),
@@ -27,61 +31,61 @@ const glm::mat4& camera::view()
     return m_view;
 }
 
-void camera::move_forward(float delta_t)
+glm::mat4 camera::view(float alpha) const
 {
-    m_pos += m_trans_speed * delta_t * m_front;
-    refresh_view();
-}
+    glm::vec3 pos = glm::mix(m_prev_pos, m_pos, alpha);
+    glm::vec3 front = facing(glm::mix(m_prev_pitch, m_pitch, alpha),
+                             glm::mix(m_prev_yaw, m_yaw, alpha));
 
-void camera::move_back(float delta_t)
-{
-    m_pos -= m_trans_speed * delta_t * m_front;
-    refresh_view();
+    return glm::lookAt(pos, pos + front, m_up);
 }
 
-void camera::move_left(float delta_t)
+const glm::vec3& camera::position() const
 {
-    glm::vec3 dir = glm::cross(m_front, m_up);
-    m_pos -= glm::normalize(dir) * m_rot_speed * delta_t;
-    refresh_view();
+    return m_pos;
 }
 
-void camera::move_right(float delta_t)
+const glm::vec3& camera::front() const
 {
-    glm::vec3 dir = glm::cross(m_front, m_up);
-    m_pos += glm::normalize(dir) * m_rot_speed * delta_t;
-    refresh_view();
+    return m_front;
 }
 
-void camera::pitch_up(float delta_t)
+void camera::update(const camera_input& input, float delta_t)
 {
-    m_pitch += m_rot_speed * delta_t;
-    refresh_view();
-}
+    m_prev_pitch = m_pitch;
+    m_prev_yaw = m_yaw;
+    m_prev_pos = m_pos;
 
-void camera::pitch_down(float delta_t)
-{
-    m_pitch -= m_rot_speed * delta_t;
+    // Turn first so this step's movement follows the new heading
+    float pitch_rate = (float)input.pitch_up - (float)input.pitch_down;
+    float yaw_rate = (float)input.yaw_right - (float)input.yaw_left;
+    m_pitch = glm::clamp(m_pitch + pitch_rate * m_rot_speed * delta_t, -89.0f, 89.0f);
+    m_yaw += yaw_rate * m_rot_speed * delta_t;
     refresh_view();
-}
 
-void camera::yaw_left(float delta_t)
-{
-    m_yaw -= m_rot_speed * delta_t;
-    refresh_view();
-}
+    glm::vec3 side = glm::normalize(glm::cross(m_front, m_up));
+    glm::vec3 dir = m_front * ((float)input.forward - (float)input.back) +
+                    side * ((float)input.right - (float)input.left);
 
-void camera::yaw_right(float delta_t)
-{
-    m_yaw += m_rot_speed * delta_t;
+    // Diagonals are no faster than moving along one axis
+    m_velocity = glm::vec3(0.0f);
+    if (glm::dot(dir, dir) > 0.0f) {
+        m_velocity = glm::normalize(dir) * m_trans_speed;
+    }
+
+    m_pos += m_velocity * delta_t;
     refresh_view();
 }
 
 void camera::refresh_view()
 {
-    m_front.x = cos(glm::radians(m_pitch)) * cos(glm::radians(m_yaw));
-    m_front.y = sin(glm::radians(m_pitch));
-    m_front.z = cos(glm::radians(m_pitch)) * sin(glm::radians(m_yaw));
-
+    m_front = facing(m_pitch, m_yaw);
     m_view = glm::lookAt(m_pos, m_pos + m_front, m_up);
 }
+
+glm::vec3 camera::facing(float pitch, float yaw)
+{
+    return glm::vec3(cos(glm::radians(pitch)) * cos(glm::radians(yaw)),
+                     sin(glm::radians(pitch)),
+                     cos(glm::radians(pitch)) * sin(glm::radians(yaw)));
+}
@@ -5,31 +5,59 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+/**
+ *  Which camera controls are held down during a frame
+ *
+ *  Kept free of SDL so recorded or scripted input can drive the camera
+ *  exactly like the keyboard does.
+ */
+struct camera_input {
+    bool forward;
+    bool back;
+    bool left;
+    bool right;
+    bool pitch_up;
+    bool pitch_down;
+    bool yaw_left;
+    bool yaw_right;
+};
+
+/**
+ *  Free-flying camera
+ *
+ *  update() integrates the held controls over a time step in seconds, so
+ *  movement speed does not depend on the frame rate; the same inputs and
+ *  time steps always produce the same path.  view(alpha) blends between
+ *  the state before and after the latest update().
+ */
 class camera {
  public:
     camera();
 
     const glm::mat4& view();
+    glm::mat4 view(float alpha) const;
+    const glm::vec3& position() const;
+    const glm::vec3& front() const;
 
-    void move_forward(float delta_t);
-    void move_back(float delta_t);
-    void move_left(float delta_t);
-    void move_right(float delta_t);
-
-    void pitch_up(float delta_t);
-    void pitch_down(float delta_t);
-    void yaw_left(float delta_t);
-    void yaw_right(float delta_t);
+    void update(const camera_input& input, float delta_t);
 
     void refresh_view();
 
  private:
+    static glm::vec3 facing(float pitch, float yaw);
+
     float m_pitch;
     float m_yaw;
 
+    // State before the latest update(), for interpolated views
+    float m_prev_pitch;
+    float m_prev_yaw;
+    glm::vec3 m_prev_pos;
+
     float m_trans_speed;
     float m_rot_speed;
 
+    glm::vec3 m_velocity;
     glm::vec3 m_pos;
     glm::vec3 m_up;
     glm::vec3 m_front;
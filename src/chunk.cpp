@@ -0,0 +1,90 @@
+// Module Header
+#include "chunk.hpp"
+
+// C Standard Headers
+#include <cassert>
+#include <cstring>
+
+chunk::chunk()
+{
+    clear();
+}
+
+void chunk::clear()
+{
+    memset(m_blocks, 0, sizeof(m_blocks));
+    memset(m_light, 0, sizeof(m_light));
+    m_solid_count = 0;
+    m_needs_save = false;
+}
+
+bool chunk::set(int x, int y, int z, block b)
+{
+    assert(in_bounds(x, y, z));
+
+    block& old = m_blocks[index(x, y, z)];
+    if (old == b) {
+        return false;
+    }
+
+    if (old == block::air) {
+        m_solid_count++;
+    } else if (b == block::air) {
+        m_solid_count--;
+    }
+
+    old = b;
+    m_needs_save = true;
+    return true;
+}
+
+const block *chunk::data() const
+{
+    return m_blocks;
+}
+
+block *chunk::data()
+{
+    return m_blocks;
+}
+
+void chunk::recount()
+{
+    m_solid_count = 0;
+    for (int i = 0; i < volume; i++) {
+        if (m_blocks[i] != block::air) {
+            m_solid_count++;
+        }
+    }
+}
+
+const uint8_t *chunk::light_data() const
+{
+    return m_light;
+}
+
+bool chunk::empty() const
+{
+    return m_solid_count == 0;
+}
+
+int chunk::solid_count() const
+{
+    return m_solid_count;
+}
+
+bool chunk::needs_save() const
+{
+    return m_needs_save;
+}
+
+void chunk::mark_saved()
+{
+    m_needs_save = false;
+}
+
+// For a chunk whose save failed after mark_saved()
+void chunk::mark_unsaved()
+{
+    m_needs_save = true;
+}
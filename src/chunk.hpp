@@ -0,0 +1,219 @@
+#ifndef CHUNK_HPP
+#define CHUNK_HPP
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <functional>
+
+/**
+ *  Block types stored in a chunk; air is always zero
+ */
+enum class block : uint8_t {
+    air = 0,
+    crate,
+    lamp,
+    water,
+    glass
+};
+
+/**
+ *  Whether a block is see-through; these are drawn blended, after
+ *  everything else
+ */
+inline bool block_translucent(block b)
+{
+    return b == block::water || b == block::glass;
+}
+
+/**
+ *  Whether a block stops light and hides the faces behind it; air and
+ *  translucent blocks do not
+ */
+inline bool block_opaque(block b)
+{
+    return b != block::air && !block_translucent(b);
+}
+
+/**
+ *  Block light level a block emits by itself, 0 for most blocks
+ */
+inline int block_emission(block b)
+{
+    return b == block::lamp ? 14 : 0;
+}
+
+/**
+ *  Light levels are 4 bits; sky light at full strength is max_light
+ */
+static const int max_light = 15;
+
+/**
+ *  The six faces of a voxel, ordered so that axis = face / 2 (x, y, z)
+ *  and the positive side of each axis is odd
+ */
+enum class face : uint8_t {
+    neg_x = 0,
+    pos_x,
+    neg_y,
+    pos_y,
+    neg_z,
+    pos_z
+};
+
+static const int face_count = 6;
+
+/**
+ *  Unit step towards the neighbor across each face, indexed by face
+ */
+static const int face_offsets[face_count][3] = {
+    {-1, 0, 0}, {1, 0, 0},
+    {0, -1, 0}, {0, 1, 0},
+    {0, 0, -1}, {0, 0, 1}
+};
+
+/**
+ *  Integer coordinate of a chunk within the world, in units of chunks
+ */
+struct chunk_coord {
+    int x;
+    int y;
+    int z;
+
+    bool operator==(const chunk_coord& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+
+    bool operator!=(const chunk_coord& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ *  Coordinate of a mesh section (a section_size^3 part of a chunk), in
+ *  units of sections
+ */
+typedef chunk_coord section_coord;
+
+/**
+ *  Hash functor so chunk_coord can key unordered containers
+ */
+struct chunk_coord_hash {
+    size_t operator()(const chunk_coord& c) const
+    {
+        size_t h = static_cast<uint32_t>(c.x) * 73856093u;
+        h ^= static_cast<uint32_t>(c.y) * 19349663u;
+        h ^= static_cast<uint32_t>(c.z) * 83492791u;
+        return h;
+    }
+};
+
+/**
+ *  Fixed size cube of voxels; the unit of storage, meshing and I/O
+ *
+ *  Blocks are laid out x-fastest, then z, then y, so one horizontal
+ *  slice of the chunk is contiguous in memory.  For meshing a chunk is
+ *  split into sections so an edit only rebuilds a fraction of it.
+ *
+ *  Each voxel also has a sky and a block light level, packed into one
+ *  byte (sky in the high nibble) in the same layout as the blocks.
+ *  Light is derived data; it is not saved and not counted as a change.
+ */
+class chunk {
+ public:
+    static const int size = 32;
+    static const int volume = size * size * size;
+    static const int section_size = 16;
+    static const int sections = size / section_size;
+
+    chunk();
+
+    void clear();
+
+    block get(int x, int y, int z) const;
+    bool set(int x, int y, int z, block b);
+
+    const block *data() const;
+    block *data();
+    void recount();
+
+    bool empty() const;
+    int solid_count() const;
+
+    bool needs_save() const;
+    void mark_saved();
+    void mark_unsaved();
+
+    int sky_light(int index) const;
+    int block_light(int index) const;
+    void set_sky_light(int index, int level);
+    void set_block_light(int index, int level);
+    const uint8_t *light_data() const;
+
+    static int index(int x, int y, int z);
+    static bool in_bounds(int x, int y, int z);
+
+ private:
+    block m_blocks[volume];
+    uint8_t m_light[volume];
+    int m_solid_count;
+    bool m_needs_save;
+};
+
+inline int chunk::index(int x, int y, int z)
+{
+    return (y * size + z) * size + x;
+}
+
+inline bool chunk::in_bounds(int x, int y, int z)
+{
+    return x >= 0 && x < size && y >= 0 && y < size && z >= 0 && z < size;
+}
+
+inline block chunk::get(int x, int y, int z) const
+{
+    return m_blocks[index(x, y, z)];
+}
+
+inline int chunk::sky_light(int index) const
+{
+    return m_light[index] >> 4;
+}
+
+inline int chunk::block_light(int index) const
+{
+    return m_light[index] & 0x0f;
+}
+
+inline void chunk::set_sky_light(int index, int level)
+{
+    m_light[index] = static_cast<uint8_t>((m_light[index] & 0x0f) | (level << 4));
+}
+
+inline void chunk::set_block_light(int index, int level)
+{
+    m_light[index] = static_cast<uint8_t>((m_light[index] & 0xf0) | level);
+}
+
+/**
+ *  Floor division helpers for mapping world block coordinates to chunks
+ */
+inline int floor_div(int value, int divisor)
+{
+    int q = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+        q--;
+    }
+    return q;
+}
+
+inline int floor_mod(int value, int divisor)
+{
+    return value - floor_div(value, divisor) * divisor;
+}
+
+#endif // CHUNK_HPP
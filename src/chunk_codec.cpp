@@ -0,0 +1,85 @@
+// Module Header
+#include "chunk_codec.hpp"
+
+// C Standard Headers
+#include <cstring>
+
+using namespace std;
+
+namespace chunk_codec {
+
+static void put_varint(vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool get_varint(const uint8_t *& p, const uint8_t *end, uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void encode(const chunk& c, vector<uint8_t>& out)
+{
+    const block *blocks = c.data();
+
+    int i = 0;
+    while (i < chunk::volume) {
+        block b = blocks[i];
+        int run = 1;
+        while (i + run < chunk::volume && blocks[i + run] == b) {
+            run++;
+        }
+
+        put_varint(out, run);
+        out.push_back(static_cast<uint8_t>(b));
+        i += run;
+    }
+}
+
+bool decode(const uint8_t *data, size_t size, chunk& c)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    block *blocks = c.data();
+
+    uint32_t filled = 0;
+    while (p != end) {
+        uint32_t run;
+        if (!get_varint(p, end, run) || p == end) {
+            return false;
+        }
+
+        if (run > static_cast<uint32_t>(chunk::volume) - filled) {
+            return false;
+        }
+
+        memset(blocks + filled, *p++, run);
+        filled += run;
+    }
+
+    if (filled != static_cast<uint32_t>(chunk::volume)) {
+        return false;
+    }
+
+    c.recount();
+    return true;
+}
+
+} // namespace chunk_codec
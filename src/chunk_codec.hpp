@@ -0,0 +1,35 @@
+#ifndef CHUNK_CODEC_HPP
+#define CHUNK_CODEC_HPP
+
+// Local Headers
+#include "chunk.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <vector>
+
+namespace chunk_codec {
+
+/**
+ *  Run-length encodes a chunk's blocks as (varint run, block) pairs
+ *
+ *  Voxel data is dominated by long runs of air or a single material, so
+ *  this gets most of the ratio of a general purpose LZ codec while
+ *  decoding with nothing but memset.  The output is appended to `out`.
+ */
+void encode(const chunk& c, std::vector<uint8_t>& out);
+
+/**
+ *  Decodes a payload produced by encode() into `c`
+ *
+ *  Returns false if the payload is truncated or does not describe
+ *  exactly chunk::volume blocks; `c` is unspecified in that case.
+ */
+bool decode(const uint8_t *data, size_t size, chunk& c);
+
+} // namespace chunk_codec
+
+#endif // CHUNK_CODEC_HPP
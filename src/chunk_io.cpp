@@ -0,0 +1,272 @@
+// Module Header
+#include "chunk_io.hpp"
+
+// Local Headers
+#include "chunk_codec.hpp"
+#include "region_file.hpp"
+#include "trace.hpp"
+
+// C Standard Headers
+#include <cstdio>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <utility>
+
+using namespace std;
+
+chunk_io::chunk_io(world_store& store, int thread_count) :
+    m_store(store),
+    m_quit(false),
+    m_queue_depth(0),
+    m_max_queue_depth(0),
+    m_batches(0),
+    m_coalesced(0),
+    m_failed(0)
+{
+    for (int i = 0; i < thread_count; i++) {
+        m_threads.emplace_back(&chunk_io::worker_main, this);
+    }
+}
+
+chunk_io::~chunk_io()
+{
+    flush();
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_work_cv.notify_all();
+
+    for (thread& t : m_threads) {
+        t.join();
+    }
+}
+
+void chunk_io::request_load(const chunk_coord& coord)
+{
+    enqueue(coord, nullptr);
+}
+
+void chunk_io::request_save(const chunk_coord& coord, const chunk& c)
+{
+    // Snapshot the chunk so the caller is free to keep editing it
+    pooled_chunk snapshot = chunk_pool::shared().make();
+    *snapshot = c;
+    enqueue(coord, move(snapshot));
+}
+
+void chunk_io::save_world(world& w)
+{
+    for (const auto& entry : w.chunks()) {
+        chunk& c = *entry.second;
+        if (!c.needs_save()) {
+            continue;
+        }
+
+        request_save(entry.first, c);
+        c.mark_saved();
+    }
+}
+
+void chunk_io::poll(vector<loaded_chunk>& out, vector<chunk_coord>& failed_saves)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    for (loaded_chunk& l : m_completed) {
+        out.push_back(move(l));
+    }
+    m_completed.clear();
+
+    failed_saves.insert(failed_saves.end(), m_failed_saves.begin(), m_failed_saves.end());
+    m_failed_saves.clear();
+}
+
+void chunk_io::flush()
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_idle_cv.wait(lock, [this] { return m_pending.empty() && m_busy.empty(); });
+}
+
+size_t chunk_io::queue_depth() const
+{
+    return m_queue_depth.load(memory_order_relaxed);
+}
+
+void chunk_io::print_stats()
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    printf("chunk_io: queue depth %zu (max %zu), %llu batches, %llu requests coalesced, %llu failed\n",
+           queue_depth(),
+           m_max_queue_depth,
+           (unsigned long long)m_batches,
+           (unsigned long long)m_coalesced,
+           (unsigned long long)m_failed);
+    m_load_latency.print("  load latency");
+    m_save_latency.print("  save latency");
+}
+
+void chunk_io::enqueue(const chunk_coord& coord, pooled_chunk data)
+{
+    request r{coord, move(data), clock::now()};
+    bool is_save = r.data != nullptr;
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        batch& b = m_pending[region_file::region_of(coord)];
+        if (is_save) {
+            b.saves.push_back(move(r));
+        } else {
+            b.loads.push_back(move(r));
+        }
+
+        size_t depth = ++m_queue_depth;
+        if (depth > m_max_queue_depth) {
+            m_max_queue_depth = depth;
+        }
+    }
+
+    m_work_cv.notify_one();
+}
+
+void chunk_io::worker_main()
+{
+    TRACE_THREAD_NAME("chunk io");
+    unique_lock<mutex> lock(m_mutex);
+
+    while (true) {
+        // Regions already being serviced keep accumulating requests; they
+        // are picked up as one batch once the current one finishes.
+        auto it = m_pending.begin();
+        while (it != m_pending.end() && m_busy.count(it->first) != 0) {
+            ++it;
+        }
+
+        if (it == m_pending.end()) {
+            if (m_quit) {
+                return;
+            }
+            m_work_cv.wait(lock);
+            continue;
+        }
+
+        chunk_coord region_coord = it->first;
+        batch b = move(it->second);
+        m_pending.erase(it);
+        m_busy.insert(region_coord);
+
+        lock.unlock();
+
+        vector<loaded_chunk> loaded;
+        batch_result result = process(region_coord, b, loaded);
+        clock::time_point done = clock::now();
+
+        lock.lock();
+
+        for (const request& r : b.loads) {
+            m_load_latency.record(chrono::duration_cast<chrono::microseconds>(done - r.queued).count());
+        }
+        for (const request& r : b.saves) {
+            m_save_latency.record(chrono::duration_cast<chrono::microseconds>(done - r.queued).count());
+        }
+
+        for (loaded_chunk& l : loaded) {
+            m_completed.push_back(move(l));
+        }
+        if (!result.saves_written) {
+            for (const request& r : b.saves) {
+                m_failed_saves.push_back(r.coord);
+            }
+        }
+
+        size_t requests = b.loads.size() + b.saves.size();
+        m_queue_depth -= requests;
+        m_coalesced += result.handled - result.issued;
+        m_failed += requests - result.handled;
+        m_batches++;
+        m_busy.erase(region_coord);
+
+        if (m_pending.count(region_coord) != 0) {
+            m_work_cv.notify_one();
+        }
+        m_idle_cv.notify_all();
+    }
+}
+
+// Requests not handled when the region throws have failed; the saves
+// may have been written even if the loads after them were not read
+chunk_io::batch_result chunk_io::process(const chunk_coord& region_coord,
+                                         batch& b,
+                                         vector<loaded_chunk>& loaded)
+{
+    TRACE_SCOPE("region batch");
+    batch_result result{0, 0, b.saves.empty()};
+
+    try {
+        region_file& r = m_store.region(region_coord);
+
+        // Saves first, so a load queued behind a save sees the new data.
+        // Only the newest save of each slot is written.
+        if (!b.saves.empty()) {
+            vector<int> slots;
+            vector<vector<uint8_t>> payloads;
+            unordered_map<int, size_t> slot_index;
+
+            for (const request& req : b.saves) {
+                int slot = region_file::slot_of(req.coord);
+                auto found = slot_index.find(slot);
+                if (found == slot_index.end()) {
+                    slot_index[slot] = slots.size();
+                    slots.push_back(slot);
+                    payloads.emplace_back();
+                    found = slot_index.find(slot);
+                }
+
+                vector<uint8_t>& payload = payloads[found->second];
+                payload.clear();
+                chunk_codec::encode(*req.data, payload);
+            }
+
+            r.write_payloads(slots.data(), payloads.data(), slots.size());
+            result.handled += b.saves.size();
+            result.issued += slots.size();
+            result.saves_written = true;
+
+            if (r.wants_compaction()) {
+                r.compact();
+            }
+        }
+
+        if (!b.loads.empty()) {
+            vector<int> slots;
+            for (const request& req : b.loads) {
+                slots.push_back(region_file::slot_of(req.coord));
+            }
+            sort(slots.begin(), slots.end());
+            slots.erase(unique(slots.begin(), slots.end()), slots.end());
+
+            r.prefetch(slots.data(), slots.size());
+
+            for (int slot : slots) {
+                loaded_chunk l{region_file::chunk_at(region_coord, slot), nullptr};
+                pooled_chunk c = chunk_pool::shared().make();
+                if (r.read_chunk(slot, *c)) {
+                    l.data = move(c);
+                }
+                loaded.push_back(move(l));
+            }
+            result.handled += b.loads.size();
+            result.issued += slots.size();
+        }
+    } catch (const exception& e) {
+        printf("chunk_io: region %d,%d,%d failed: %s\n",
+               region_coord.x, region_coord.y, region_coord.z, e.what());
+    }
+
+    return result;
+}
@@ -0,0 +1,112 @@
+#ifndef CHUNK_IO_HPP
+#define CHUNK_IO_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "chunk_pool.hpp"
+#include "latency_histogram.hpp"
+#include "world.hpp"
+#include "world_store.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ *  Asynchronous chunk loads and saves on a small pool of I/O threads
+ *
+ *  Requests are queued per region file.  A worker claims every pending
+ *  request for one region at a time, so requests that pile up while the
+ *  region is busy are coalesced into a single batch: duplicate loads and
+ *  superseded saves are dropped, saves become one append, and loads are
+ *  issued in file order behind one readahead hint.  The render thread
+ *  only ever takes the queue lock briefly, in request_*() and poll().
+ *
+ *  save_world() marks chunks saved as it queues them.  poll() hands back
+ *  the coordinates of saves whose region failed, so the owner can mark
+ *  those chunks unsaved again.
+ */
+class chunk_io {
+ public:
+    struct loaded_chunk {
+        chunk_coord coord;
+        pooled_chunk data; // Null if the chunk was never saved
+    };
+
+    chunk_io(world_store& store, int thread_count = 2);
+    ~chunk_io();
+
+    chunk_io(const chunk_io&) = delete;
+    chunk_io& operator=(const chunk_io&) = delete;
+
+    void request_load(const chunk_coord& coord);
+    void request_save(const chunk_coord& coord, const chunk& c);
+    void save_world(world& w);
+
+    void poll(std::vector<loaded_chunk>& out, std::vector<chunk_coord>& failed_saves);
+    void flush();
+
+    size_t queue_depth() const;
+    void print_stats();
+
+ private:
+    typedef std::chrono::steady_clock clock;
+
+    struct request {
+        chunk_coord coord;
+        pooled_chunk data;
+        clock::time_point queued;
+    };
+
+    struct batch {
+        std::vector<request> loads;
+        std::vector<request> saves;
+    };
+
+    // Requests of a batch that were carried out, and the file operations
+    // they came down to once coalesced
+    struct batch_result {
+        size_t handled;
+        size_t issued;
+        bool saves_written;
+    };
+
+    void enqueue(const chunk_coord& coord, pooled_chunk data);
+    void worker_main();
+    batch_result process(const chunk_coord& region_coord,
+                         batch& b,
+                         std::vector<loaded_chunk>& loaded);
+
+    world_store& m_store;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_idle_cv;
+    std::unordered_map<chunk_coord, batch, chunk_coord_hash> m_pending;
+    std::unordered_set<chunk_coord, chunk_coord_hash> m_busy;
+    std::vector<loaded_chunk> m_completed;
+    std::vector<chunk_coord> m_failed_saves;
+    bool m_quit;
+
+    std::atomic<size_t> m_queue_depth;
+    size_t m_max_queue_depth;
+    uint64_t m_batches;
+    uint64_t m_coalesced;
+    uint64_t m_failed;
+    latency_histogram m_load_latency;
+    latency_histogram m_save_latency;
+};
+
+#endif // CHUNK_IO_HPP
@@ -0,0 +1,150 @@
+// Module Header
+#include "chunk_pool.hpp"
+
+// C Standard Headers
+#include <cassert>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+void chunk_releaser::operator()(chunk *) const
+{
+    chunk_pool::shared().release(handle);
+}
+
+chunk_pool::chunk_pool() :
+    m_free(no_slot),
+    m_live(0),
+    m_high_water(0),
+    m_made(0),
+    m_reused(0)
+{
+}
+
+pooled_chunk chunk_pool::make()
+{
+    chunk_handle handle;
+    bool reused;
+    slot *s;
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        if (m_free == no_slot) {
+            add_page();
+        }
+
+        handle.index = m_free;
+        s = &slot_at(m_free);
+        m_free = s->next_free;
+        handle.generation = s->generation;
+        reused = s->used;
+        s->used = true;
+
+        m_live++;
+        m_high_water = max(m_high_water, m_live);
+        m_made++;
+        if (reused) {
+            m_reused++;
+        }
+    }
+
+    // Fresh pages are already clear; the slot is ours, so no lock needed
+    if (reused) {
+        s->data.clear();
+    }
+
+    return pooled_chunk(&s->data, chunk_releaser{handle});
+}
+
+void chunk_pool::release(chunk_handle handle)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    slot& s = slot_at(handle.index);
+    assert(s.generation == handle.generation);
+
+    // Skip 0 on wrap so a stale handle can never look like a null one
+    if (++s.generation == 0) {
+        s.generation = 1;
+    }
+    s.next_free = m_free;
+    m_free = handle.index;
+    m_live--;
+}
+
+chunk *chunk_pool::get(chunk_handle handle)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    if (!handle.valid() || handle.index >= m_pages.size() * page_chunks) {
+        return nullptr;
+    }
+
+    slot& s = slot_at(handle.index);
+    return s.generation == handle.generation ? &s.data : nullptr;
+}
+
+void chunk_pool::reserve(size_t count)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    while (m_pages.size() * page_chunks < count) {
+        add_page();
+    }
+}
+
+chunk_pool::stats chunk_pool::get_stats() const
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    size_t capacity = m_pages.size() * page_chunks;
+    return stats{m_live, m_high_water, capacity, capacity * sizeof(slot), m_made, m_reused};
+}
+
+void chunk_pool::print_stats() const
+{
+    stats s = get_stats();
+
+    printf("chunk_pool: %zu live, high water %zu (%.1f MB), %zu slots (%.1f MB reserved)\n",
+           s.live,
+           s.high_water,
+           s.high_water * sizeof(slot) / (1024.0 * 1024.0),
+           s.capacity,
+           s.reserved_bytes / (1024.0 * 1024.0));
+    printf("chunk_pool: %llu chunks made, %llu from recycled slots\n",
+           (unsigned long long)s.made,
+           (unsigned long long)s.reused);
+}
+
+chunk_pool& chunk_pool::shared()
+{
+    static chunk_pool pool;
+    return pool;
+}
+
+// Constructing the page clears every chunk in it, which also faults the
+// memory in up front rather than on first use
+void chunk_pool::add_page()
+{
+    uint32_t first = static_cast<uint32_t>(m_pages.size() * page_chunks);
+    m_pages.push_back(unique_ptr<slot[]>(new slot[page_chunks]));
+
+    slot *page = m_pages.back().get();
+    for (int i = page_chunks - 1; i >= 0; i--) {
+        page[i].generation = 1;
+        page[i].next_free = m_free;
+        page[i].used = false;
+        m_free = first + i;
+    }
+}
+
+chunk_pool::slot& chunk_pool::slot_at(uint32_t index) const
+{
+    return m_pages[index / page_chunks][index % page_chunks];
+}
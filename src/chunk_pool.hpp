@@ -0,0 +1,115 @@
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+// Local Headers
+#include "chunk.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ *  Stable reference to a pooled chunk
+ *
+ *  The generation changes every time the slot is reused, so a handle
+ *  kept after its chunk was released resolves to null rather than to
+ *  whatever chunk moved into the slot.  Generation 0 is never issued.
+ */
+struct chunk_handle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool valid() const
+    {
+        return generation != 0;
+    }
+
+    bool operator==(const chunk_handle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+};
+
+/**
+ *  Returns a chunk to the pool it came from; the deleter of pooled_chunk
+ */
+struct chunk_releaser {
+    chunk_handle handle;
+
+    void operator()(chunk *c) const;
+};
+
+typedef std::unique_ptr<chunk, chunk_releaser> pooled_chunk;
+
+/**
+ *  Free-list allocator for chunks
+ *
+ *  Chunks live in slots carved out of pages of page_chunks at a time.
+ *  Pages are never freed, so a released slot goes back on the free list
+ *  and the next make() reuses memory that is already mapped and warm
+ *  instead of asking the heap for another 64 KB block.  Loading and
+ *  saving churn through chunks constantly (every save takes a snapshot)
+ *  and this keeps that from fragmenting the heap or faulting in fresh
+ *  pages.  Chunks from make() come back cleared to air.
+ *
+ *  The pool is shared by the world and the I/O threads and locks around
+ *  the free list only; the chunks themselves are not synchronized.
+ */
+class chunk_pool {
+ public:
+    static const int page_chunks = 16;
+
+    struct stats {
+        size_t live;
+        size_t high_water;
+        size_t capacity;
+        size_t reserved_bytes;
+        uint64_t made;
+        uint64_t reused;
+    };
+
+    chunk_pool();
+
+    chunk_pool(const chunk_pool&) = delete;
+    chunk_pool& operator=(const chunk_pool&) = delete;
+
+    pooled_chunk make();
+    void release(chunk_handle handle);
+
+    chunk *get(chunk_handle handle);
+    void reserve(size_t count);
+
+    stats get_stats() const;
+    void print_stats() const;
+
+    static chunk_pool& shared();
+
+ private:
+    static const uint32_t no_slot = UINT32_MAX;
+
+    struct slot {
+        chunk data;
+        uint32_t generation;
+        uint32_t next_free;
+        bool used;
+    };
+
+    void add_page();
+    slot& slot_at(uint32_t index) const;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<slot[]>> m_pages;
+    uint32_t m_free;
+
+    size_t m_live;
+    size_t m_high_water;
+    uint64_t m_made;
+    uint64_t m_reused;
+};
+
+#endif // CHUNK_POOL_HPP
@@ -0,0 +1,681 @@
+// Module Header
+#include "chunk_renderer.hpp"
+
+// Local Headers
+#include "cube.hpp"
+#include "trace.hpp"
+
+// External Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// C Standard Headers
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static_assert(mesher::max_quads * cube::face_corner_count <= 65536,
+              "quad indices must fit in GL_UNSIGNED_SHORT");
+
+// Texture units of the section's face records and the shadow cascades
+static const int s_face_unit = 2;
+static const int s_shadow_unit = 3;
+
+// Empty meshes kept for reuse; beyond this they are freed
+static const size_t s_max_spare_meshes = 256;
+
+// Defines for each terrain_feature bit, in bit order
+static const vector<string> s_feature_defines = {
+    "AO", "FOG", "TRANSLUCENT", "DEPTH_ONLY", "OVERDRAW", "SHADOWS", "SHADOW_CASTER"
+};
+
+// Sort keys are distances in 1/16ths of a block, saturating at 4096 blocks
+static const float s_distance_scale = 16.0f;
+static const int s_key_bits = 16;
+static const int s_radix_bits = 8;
+static const int s_radix = 1 << s_radix_bits;
+
+// Alpha of water faces, the translucent shader's "trans"
+static const float s_water_opacity = 0.6f;
+
+// Direction the sunlight travels in, down and across the terrain
+static const glm::vec3 s_sun_direction(0.4f, -1.0f, 0.3f);
+
+// Polygon offset for shadow casters (factor, units), so lit faces do not
+// shadow themselves
+static const float s_shadow_slope_bias = 2.0f;
+static const float s_shadow_bias = 4.0f;
+
+// GPU profiler scope for each cascade
+static const char *const s_cascade_scopes[] = {
+    "shadow cascade 0", "shadow cascade 1", "shadow cascade 2"
+};
+static_assert(sizeof(s_cascade_scopes) / sizeof(s_cascade_scopes[0]) == shadow_cascades::cascade_count,
+              "one profiler scope per shadow cascade");
+
+// Names of the elements of a uniform array, built once so that setting
+// them every frame does not allocate
+static vector<string> uniform_array(const string& name, int count)
+{
+    vector<string> names;
+    for (int i = 0; i < count; i++) {
+        names.push_back(name + "[" + to_string(i) + "]");
+    }
+    return names;
+}
+
+static const vector<string> s_shadow_matrix_names = uniform_array("shadow_matrix", shadow_cascades::cascade_count);
+static const vector<string> s_cascade_far_names = uniform_array("cascade_far", shadow_cascades::cascade_count);
+static const vector<string> s_shadow_texel_names = uniform_array("shadow_texel", shadow_cascades::cascade_count);
+
+chunk_renderer::chunk_renderer() :
+    m_shaders(m_vertex_shader_filename, m_fragment_shader_filename, s_feature_defines),
+    m_shader_program(nullptr),
+    m_translucent_program(nullptr),
+    m_depth_program(nullptr),
+    m_caster_program(nullptr),
+    m_features(0),
+    m_depth_prepass(false),
+    m_overdraw(false),
+    m_projection(1.0f),
+    m_texture(m_texture_filename, false),
+    m_translucent_texture(m_translucent_texture_filename, true),
+    m_shadows(s_sun_direction),
+    m_eye_valid(false),
+    m_eye(0.0f),
+    m_eye_chunk{0, 0, 0},
+    m_stats{}
+{
+    // Shadows need the most of the driver; without them the terrain
+    // still draws, so a failed build of those variants is not fatal
+    try {
+        set_features(default_features);
+    } catch (const exception& e) {
+        fprintf(stderr, "Terrain shadows disabled, shader variant failed to build: %s\n", e.what());
+        set_features(default_features & ~terrain_shadows);
+    }
+
+    // The element array binding is VAO state; no attributes are needed
+    // since the vertex shader fetches everything itself
+    vector<uint16_t> indices;
+    indices.reserve(mesher::max_quads * cube::face_index_count);
+    for (int quad = 0; quad < mesher::max_quads; quad++) {
+        for (uint16_t index : cube::quad_indices) {
+            indices.push_back(quad * cube::face_corner_count + index);
+        }
+    }
+
+    m_vao.bind();
+    m_quad_indices.load(indices.data(), indices.size() * sizeof(uint16_t));
+}
+
+void chunk_renderer::set_projection(const glm::mat4& projection_mat)
+{
+    m_projection = projection_mat;
+    m_shadows.set_projection(projection_mat);
+    for (gl_wrapper::shader_program *program : {m_shader_program, m_translucent_program, m_depth_program}) {
+        program->use();
+        program->set_uniform4fv("projection", glm::value_ptr(projection_mat));
+    }
+}
+
+void chunk_renderer::set_features(uint32_t features)
+{
+    if (m_shader_program != nullptr && features == m_features) {
+        return;
+    }
+
+    select_programs(features, m_overdraw);
+}
+
+// Each variant is its own program with its own uniforms.  All are built
+// before any is switched to, so a failed build changes nothing.
+void chunk_renderer::select_programs(uint32_t features, bool overdraw)
+{
+    uint32_t mode = overdraw ? terrain_overdraw : 0;
+    gl_wrapper::shader_program& opaque = m_shaders.get(features | mode);
+    gl_wrapper::shader_program& translucent = m_shaders.get(features | mode | terrain_translucent);
+    gl_wrapper::shader_program& depth = m_shaders.get(terrain_depth_only);
+    gl_wrapper::shader_program& caster = m_shaders.get(terrain_shadow_caster);
+    m_shader_program = &opaque;
+    m_translucent_program = &translucent;
+    m_depth_program = &depth;
+    m_caster_program = &caster;
+    m_features = features;
+    m_overdraw = overdraw;
+
+    // The caster's projection is set per cascade; it is its own program
+    // so that does not disturb the camera's depth program
+    for (gl_wrapper::shader_program *program : {m_shader_program, m_translucent_program,
+                                                m_depth_program, m_caster_program}) {
+        program->use();
+        program->set_uniformi("texture0", 0);
+        program->set_uniformi("faces", s_face_unit);
+        program->set_uniform4fv("projection", glm::value_ptr(m_projection));
+    }
+    m_translucent_program->set_uniformi("texture1", 1);
+    m_translucent_program->set_uniformf("trans", s_water_opacity);
+
+    const glm::vec3& sun = m_shadows.sun_direction();
+    for (gl_wrapper::shader_program *program : {m_shader_program, m_translucent_program}) {
+        program->use();
+        program->set_uniformi("shadow_map", s_shadow_unit);
+        program->set_uniform3f("sun_direction", sun.x, sun.y, sun.z);
+    }
+}
+
+uint32_t chunk_renderer::features() const
+{
+    return m_features;
+}
+
+void chunk_renderer::watch_shaders(shader_watcher& watcher)
+{
+    m_shaders.watch(watcher);
+}
+
+void chunk_renderer::set_depth_prepass(bool enabled)
+{
+    m_depth_prepass = enabled;
+}
+
+bool chunk_renderer::depth_prepass() const
+{
+    return m_depth_prepass;
+}
+
+void chunk_renderer::set_overdraw(bool enabled)
+{
+    if (enabled != m_overdraw) {
+        select_programs(m_features, enabled);
+    }
+}
+
+bool chunk_renderer::overdraw() const
+{
+    return m_overdraw;
+}
+
+void chunk_renderer::set_shadow_amortize(bool enabled)
+{
+    m_shadows.set_amortize(enabled);
+}
+
+bool chunk_renderer::shadow_amortize() const
+{
+    return m_shadows.amortize();
+}
+
+// Rebuilds only the dirty sections, so a block edit costs a handful of
+// remeshes and shows on the next draw()
+void chunk_renderer::update(world& w)
+{
+    TRACE_SCOPE("remesh");
+    m_dirty.clear();
+    w.take_dirty_sections(m_dirty);
+
+    // Starts the frame's stats; both draws add to them
+    m_stats.draw_calls = 0;
+    m_stats.triangles = 0;
+    m_stats.binds_and_uniforms = 0;
+    m_stats.sections_drawn = 0;
+    m_stats.translucent_drawn = 0;
+    m_stats.shadow_passes = 0;
+    m_stats.shadow_sections = 0;
+    m_stats.sections_remeshed = m_dirty.size();
+    m_stats.sections_resorted = 0;
+
+    for (const section_coord& coord : m_dirty) {
+        m_mesher.mesh(w, coord, m_faces, m_translucent_faces);
+
+        if (m_faces.empty() && m_translucent_faces.empty()) {
+            remove(coord);
+        } else {
+            upload(coord, m_faces, m_translucent_faces);
+        }
+    }
+}
+
+// Stable LSD radix sort on the keys, a byte per pass.  There is an even
+// number of passes, so the result ends up back in items.
+template <typename T>
+static void radix_sort(T *items, T *scratch, size_t count)
+{
+    for (int shift = 0; shift < s_key_bits; shift += s_radix_bits) {
+        size_t offsets[s_radix + 1] = {};
+        for (size_t i = 0; i < count; i++) {
+            offsets[((items[i].key >> shift) & (s_radix - 1)) + 1]++;
+        }
+        for (int digit = 1; digit <= s_radix; digit++) {
+            offsets[digit] += offsets[digit - 1];
+        }
+        for (size_t i = 0; i < count; i++) {
+            scratch[offsets[(items[i].key >> shift) & (s_radix - 1)]++] = items[i];
+        }
+        swap(items, scratch);
+    }
+}
+
+// Opaque sections go front to back, so near terrain fills the depth
+// buffer first and hidden fragments are rejected before shading.  Each
+// section's face records are read from a buffer texture by the vertex
+// shader, drawn from the shared quad indices and an empty VAO.  Overdraw
+// mode adds a fixed colour per fragment shaded instead, so brightness
+// shows how often each pixel was shaded.
+void chunk_renderer::draw(const glm::mat4& view, frame_arena& arena)
+{
+    TRACE_SCOPE("draw terrain");
+    uint64_t binds_before = gl_wrapper::binds_and_uniforms();
+    glm::vec3 eye(glm::inverse(view)[3]);
+
+    // This frame's draw lists, opaque sections nearest first and
+    // translucent ones farthest first, gone when the arena is reset
+    arena_allocator<draw_item> allocator(arena);
+    arena_vector<draw_item> draw_list(allocator);
+    arena_vector<draw_item> translucent_list(allocator);
+    draw_list.reserve(m_sections.size());
+    translucent_list.reserve(m_sections.size());
+    glm::vec3 center_eye = eye - glm::vec3(chunk::section_size * 0.5f);
+    for (auto& entry : m_sections) {
+        section_mesh *s = entry.second.get();
+        float distance = glm::length(s->origin - center_eye) * s_distance_scale;
+        uint16_t key = static_cast<uint16_t>(min(distance, 65535.0f));
+        if (s->quad_count > 0) {
+            draw_list.push_back(draw_item{key, s});
+        }
+        if (s->translucent_quad_count > 0) {
+            translucent_list.push_back(draw_item{static_cast<uint16_t>(65535 - key), s});
+        }
+    }
+
+    arena_vector<draw_item> scratch(max(draw_list.size(), translucent_list.size()),
+                                    draw_item{0, nullptr}, allocator);
+    radix_sort(draw_list.data(), scratch.data(), draw_list.size());
+    radix_sort(translucent_list.data(), scratch.data(), translucent_list.size());
+
+    m_vao.bind();
+    glActiveTexture(GL_TEXTURE0 + s_face_unit);
+
+    if (m_depth_prepass) {
+        draw_depth(draw_list, view);
+
+        // The depth buffer is final; shade only what matches it
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    if (m_overdraw) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    }
+
+    m_shader_program->use();
+    glActiveTexture(GL_TEXTURE0);
+    m_texture.bind();
+    glActiveTexture(GL_TEXTURE0 + s_face_unit);
+    m_shader_program->set_uniform4fv("view", glm::value_ptr(view));
+
+    if (m_features & terrain_shadows) {
+        glActiveTexture(GL_TEXTURE0 + s_shadow_unit);
+        m_shadows.bind_texture();
+        glActiveTexture(GL_TEXTURE0 + s_face_unit);
+        set_shadow_uniforms(*m_shader_program);
+    }
+
+    for (const draw_item& item : draw_list) {
+        section_mesh& s = *item.mesh;
+
+        s.faces.bind();
+        m_shader_program->set_uniform4fv("model", glm::value_ptr(s.model));
+        draw_quads(s.quad_count);
+
+        m_stats.sections_drawn++;
+    }
+
+    if (m_depth_prepass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+    if (m_overdraw) {
+        glDisable(GL_BLEND);
+    }
+
+    update_eye(eye);
+    draw_translucent(translucent_list, view);
+
+    m_stats.binds_and_uniforms += gl_wrapper::binds_and_uniforms() - binds_before;
+}
+
+// Depth pre-pass with a trivial fragment shader; the shaded pass after it
+// then only runs for the fragments that end up visible
+void chunk_renderer::draw_depth(const arena_vector<draw_item>& draw_list, const glm::mat4& view)
+{
+    TRACE_SCOPE("depth pre-pass");
+    m_depth_program->use();
+    m_depth_program->set_uniform4fv("view", glm::value_ptr(view));
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    for (const draw_item& item : draw_list) {
+        section_mesh& s = *item.mesh;
+
+        s.faces.bind();
+        m_depth_program->set_uniform4fv("model", glm::value_ptr(s.model));
+        draw_quads(s.quad_count);
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+// Redraws the cascades that are due this frame into their own layers and
+// puts the framebuffer and viewport back afterwards.  Only opaque faces
+// cast shadows.  Must come before draw(), which shades with the cascades.
+void chunk_renderer::draw_shadows(const glm::mat4& view, gl_wrapper::gpu_profiler& gpu)
+{
+    if (!(m_features & terrain_shadows)) {
+        return;
+    }
+    TRACE_SCOPE("draw shadows");
+
+    uint32_t due = m_shadows.update(view);
+    if (due == 0) {
+        return;
+    }
+
+    uint64_t binds_before = gl_wrapper::binds_and_uniforms();
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    m_vao.bind();
+    m_caster_program->use();
+    m_caster_program->set_uniform4fv("view", glm::value_ptr(m_shadows.light_view()));
+    glActiveTexture(GL_TEXTURE0 + s_face_unit);
+
+    // Casters nearer the sun than a cascade's box are flattened onto its
+    // near plane instead of being clipped away
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(s_shadow_slope_bias, s_shadow_bias);
+
+    for (int i = 0; i < shadow_cascades::cascade_count; i++) {
+        if (due & (1u << i)) {
+            gl_wrapper::gpu_scope scope(gpu, s_cascade_scopes[i]);
+            draw_cascade(i);
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    m_stats.binds_and_uniforms += gl_wrapper::binds_and_uniforms() - binds_before;
+}
+
+// Sections are culled against the cascade's box only; the order does not
+// matter much for a depth only pass this small
+void chunk_renderer::draw_cascade(int cascade)
+{
+    m_shadows.bind_target(cascade);
+    m_caster_program->set_uniform4fv("projection", glm::value_ptr(m_shadows.projection(cascade)));
+    m_stats.shadow_passes++;
+
+    glm::vec3 size(chunk::section_size);
+    for (auto& entry : m_sections) {
+        section_mesh& s = *entry.second;
+        if (s.quad_count == 0 || !m_shadows.casts_into(cascade, s.origin, s.origin + size)) {
+            continue;
+        }
+
+        s.faces.bind();
+        m_caster_program->set_uniform4fv("model", glm::value_ptr(s.model));
+        draw_quads(s.quad_count);
+
+        m_stats.shadow_sections++;
+    }
+}
+
+// Each cascade is sampled with the matrix it was last drawn with, which
+// for an amortized cascade may be a few frames old
+void chunk_renderer::set_shadow_uniforms(gl_wrapper::shader_program& program)
+{
+    for (int i = 0; i < shadow_cascades::cascade_count; i++) {
+        program.set_uniform4fv(s_shadow_matrix_names[i], glm::value_ptr(m_shadows.matrix(i)));
+        program.set_uniformf(s_cascade_far_names[i], m_shadows.split(i));
+        program.set_uniformf(s_shadow_texel_names[i], m_shadows.texel_size(i));
+    }
+}
+
+// Resorts every translucent section when the eye enters another chunk
+void chunk_renderer::update_eye(const glm::vec3& eye)
+{
+    chunk_coord eye_chunk = world::chunk_of((int)floorf(eye.x),
+                                            (int)floorf(eye.y),
+                                            (int)floorf(eye.z));
+    if (m_eye_valid && eye_chunk == m_eye_chunk) {
+        return;
+    }
+
+    m_eye_valid = true;
+    m_eye = eye;
+    m_eye_chunk = eye_chunk;
+    for (auto& entry : m_sections) {
+        if (entry.second->translucent_quad_count > 0) {
+            sort_translucent(*entry.second);
+        }
+    }
+}
+
+// Water and glass, after all opaque sections, blended and without depth
+// writes so the opaque pass keeps its early depth rejection.  Sections
+// come farthest first and their faces are sorted, so blending comes out
+// back to front.
+void chunk_renderer::draw_translucent(const arena_vector<draw_item>& translucent_list,
+                                      const glm::mat4& view)
+{
+    if (translucent_list.empty()) {
+        return;
+    }
+    TRACE_SCOPE("draw translucent");
+
+    m_translucent_program->use();
+    m_translucent_program->set_uniform4fv("view", glm::value_ptr(view));
+    if (m_features & terrain_shadows) {
+        set_shadow_uniforms(*m_translucent_program);
+    }
+    glActiveTexture(GL_TEXTURE1);
+    m_translucent_texture.bind();
+    glActiveTexture(GL_TEXTURE0 + s_face_unit);
+
+    // Blended over the opaque pass; depth is tested but not written, so
+    // faces behind nearer translucent ones still show through
+    glEnable(GL_BLEND);
+    if (m_overdraw) {
+        glBlendFunc(GL_ONE, GL_ONE);
+    } else {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glDepthMask(GL_FALSE);
+
+    for (const draw_item& item : translucent_list) {
+        section_mesh& s = *item.mesh;
+
+        s.translucent.bind();
+        m_translucent_program->set_uniform4fv("model", glm::value_ptr(s.model));
+        draw_quads(s.translucent_quad_count);
+
+        m_stats.translucent_drawn++;
+    }
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+// The shared index buffer covers max_quads quads; longer lists are drawn
+// in runs, the base vertex carrying gl_VertexID on to the later records
+void chunk_renderer::draw_quads(GLsizei quad_count)
+{
+    for (GLsizei first = 0; first < quad_count; first += mesher::max_quads) {
+        GLsizei run = min<GLsizei>(quad_count - first, mesher::max_quads);
+        glDrawElementsBaseVertex(GL_TRIANGLES,
+                                 run * cube::face_index_count,
+                                 GL_UNSIGNED_SHORT,
+                                 (void *)0,
+                                 first * cube::face_corner_count);
+
+        m_stats.draw_calls++;
+        m_stats.triangles += run * 2;
+    }
+}
+
+size_t chunk_renderer::section_count() const
+{
+    return m_sections.size();
+}
+
+const render_stats& chunk_renderer::stats() const
+{
+    return m_stats;
+}
+
+void chunk_renderer::upload(const section_coord& coord,
+                            const vector<uint32_t>& faces,
+                            const vector<uint32_t>& translucent_faces)
+{
+    TRACE_SCOPE("upload section");
+    unique_ptr<section_mesh>& slot = m_sections[coord];
+    if (!slot) {
+        slot = take_spare(faces.size() * sizeof(uint32_t));
+        slot->quad_count = 0;
+        slot->translucent_quad_count = 0;
+        slot->bytes = 0;
+
+        slot->origin = glm::vec3(coord.x * chunk::section_size,
+                                 coord.y * chunk::section_size,
+                                 coord.z * chunk::section_size);
+        slot->model = glm::translate(glm::mat4(1.0f), slot->origin);
+    }
+
+    load_faces(slot->faces, faces);
+    slot->quad_count = faces.size() / mesher::face_words;
+
+    slot->translucent_faces = translucent_faces;
+    slot->translucent_quad_count = translucent_faces.size() / mesher::face_words;
+    if (!translucent_faces.empty()) {
+        sort_translucent(*slot);
+    }
+
+    size_t bytes = (faces.size() + translucent_faces.size()) * sizeof(uint32_t);
+    m_stats.buffer_bytes += bytes - slot->bytes;
+    slot->bytes = bytes;
+}
+
+// Empty lists leave the buffer as it is; nothing is drawn from it
+void chunk_renderer::load_faces(gl_wrapper::buffer_texture& buffer, const vector<uint32_t>& faces)
+{
+    if (faces.empty()) {
+        return;
+    }
+
+    size_t capacity = buffer.capacity();
+    glActiveTexture(GL_TEXTURE0 + s_face_unit);
+    buffer.load(faces.data(), faces.size() * sizeof(uint32_t));
+
+    m_stats.buffer_capacity += buffer.capacity() - capacity;
+    m_stats.buffer_high_water = max(m_stats.buffer_high_water, m_stats.buffer_capacity);
+}
+
+// Faces sorted farthest first from where the eye was at the last resort.
+// Only redone when the eye enters another chunk or the section is
+// remeshed; within a chunk the order barely changes.
+void chunk_renderer::sort_translucent(section_mesh& s)
+{
+    TRACE_SCOPE("sort translucent");
+    glm::vec3 eye = m_eye - s.origin;
+
+    m_sort_keys.clear();
+    for (size_t i = 0; i < s.translucent_faces.size(); i += mesher::face_words) {
+        float center[3];
+        mesher::face_center(s.translucent_faces[i], center);
+
+        glm::vec3 d = glm::vec3(center[0], center[1], center[2]) - eye;
+        m_sort_keys.emplace_back(glm::dot(d, d), static_cast<uint32_t>(i));
+    }
+    sort(m_sort_keys.begin(), m_sort_keys.end(),
+         [](const pair<float, uint32_t>& a, const pair<float, uint32_t>& b) {
+             return a.first > b.first;
+         });
+
+    m_sorted_faces.clear();
+    for (const pair<float, uint32_t>& key : m_sort_keys) {
+        const uint32_t *face = &s.translucent_faces[key.second];
+        m_sorted_faces.insert(m_sorted_faces.end(), face, face + mesher::face_words);
+    }
+
+    load_faces(s.translucent, m_sorted_faces);
+    m_stats.sections_resorted++;
+}
+
+void chunk_renderer::remove(const section_coord& coord)
+{
+    auto it = m_sections.find(coord);
+    if (it == m_sections.end()) {
+        return;
+    }
+
+    section_mesh& s = *it->second;
+    m_stats.buffer_bytes -= s.bytes;
+
+    if (m_spare.size() < s_max_spare_meshes) {
+        m_spare.push_back(move(it->second));
+    } else {
+        m_stats.buffer_capacity -= s.faces.capacity() + s.translucent.capacity();
+    }
+    m_sections.erase(it);
+    m_stats.spare_meshes = m_spare.size();
+}
+
+// Meshes of sections that became empty are reused, buffers and all, so
+// streaming sections does not keep creating GL objects.  Picks the
+// smallest spare that holds the mesh without growing, or else the
+// largest, so big stores are not spent on small meshes
+unique_ptr<chunk_renderer::section_mesh> chunk_renderer::take_spare(size_t bytes)
+{
+    if (m_spare.empty()) {
+        return make_unique<section_mesh>();
+    }
+
+    size_t best = 0;
+    for (size_t i = 1; i < m_spare.size(); i++) {
+        size_t capacity = m_spare[i]->faces.capacity();
+        size_t best_capacity = m_spare[best]->faces.capacity();
+        bool fits = capacity >= bytes;
+        bool best_fits = best_capacity >= bytes;
+
+        if (fits ? (!best_fits || capacity < best_capacity) : (!best_fits && capacity > best_capacity)) {
+            best = i;
+        }
+    }
+
+    unique_ptr<section_mesh> mesh = move(m_spare[best]);
+    m_spare[best] = move(m_spare.back());
+    m_spare.pop_back();
+    m_stats.spare_meshes = m_spare.size();
+    return mesh;
+}
+
+const string chunk_renderer::m_vertex_shader_filename = "cube_vert.glsl";
+const string chunk_renderer::m_fragment_shader_filename = "cube_frag.glsl";
+const string chunk_renderer::m_texture_filename = "container.jpg";
+const string chunk_renderer::m_translucent_texture_filename = "awesomeface.png";
@@ -0,0 +1,182 @@
+#ifndef CHUNK_RENDERER_HPP
+#define CHUNK_RENDERER_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "frame_arena.hpp"
+#include "gl_wrapper.hpp"
+#include "gpu_profiler.hpp"
+#include "mesher.hpp"
+#include "shader_cache.hpp"
+#include "shader_watcher.hpp"
+#include "shadow_cascades.hpp"
+#include "world.hpp"
+
+// External Headers
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// C++ Standard Headers
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ *  What the last update(), draw_shadows() and draw() did, for the stats
+ *  overlay
+ *
+ *  Binds and uniforms are those the draws made through gl_wrapper (see
+ *  gl_wrapper::binds_and_uniforms()), not every GL state change.
+ *  Buffer bytes is the total size of the section meshes; capacity adds
+ *  the slack in their stores and the spare meshes kept for reuse, and
+ *  the high water mark is the most capacity ever held.
+ *  Sections drawn counts opaque section draws only; translucent ones
+ *  are counted separately, as are sections whose translucent faces were
+ *  sorted again.  Shadow sections counts section draws over all the
+ *  shadow cascades redrawn, which are counted in shadow passes; their
+ *  draw calls and triangles are included in the totals.
+ */
+struct render_stats {
+    size_t draw_calls;
+    size_t triangles;
+    size_t binds_and_uniforms;
+    size_t sections_drawn;
+    size_t translucent_drawn;
+    size_t shadow_passes;
+    size_t shadow_sections;
+    size_t sections_remeshed;
+    size_t sections_resorted;
+    size_t buffer_bytes;
+    size_t buffer_capacity;
+    size_t buffer_high_water;
+    size_t spare_meshes;
+};
+
+/**
+ *  Optional parts of terrain shading, compiled into the shaders rather
+ *  than branched on per fragment.  AO, fog and shadows are user options;
+ *  the renderer adds the others to pick the program for each pass.
+ */
+enum terrain_feature : uint32_t {
+    terrain_ao = 1 << 0,
+    terrain_fog = 1 << 1,
+    terrain_translucent = 1 << 2,
+    terrain_depth_only = 1 << 3,
+    terrain_overdraw = 1 << 4,
+    terrain_shadows = 1 << 5,
+    terrain_shadow_caster = 1 << 6
+};
+
+/**
+ *  Owns the GPU meshes for every non-empty section of a world, remeshes
+ *  the sections the world reports as dirty and draws them
+ */
+class chunk_renderer {
+ public:
+    static const uint32_t default_features = terrain_ao | terrain_shadows;
+
+    chunk_renderer();
+
+    void set_projection(const glm::mat4& projection_mat);
+
+    void update(world& w);
+    void draw_shadows(const glm::mat4& view, gl_wrapper::gpu_profiler& gpu);
+    void draw(const glm::mat4& view, frame_arena& arena);
+
+    size_t section_count() const;
+    const render_stats& stats() const;
+
+    void set_features(uint32_t features);
+    uint32_t features() const;
+    void watch_shaders(shader_watcher& watcher);
+
+    void set_depth_prepass(bool enabled);
+    bool depth_prepass() const;
+    void set_overdraw(bool enabled);
+    bool overdraw() const;
+    void set_shadow_amortize(bool enabled);
+    bool shadow_amortize() const;
+
+ private:
+    struct section_mesh {
+        section_mesh() : faces(GL_RG32UI), translucent(GL_RG32UI) {}
+
+        gl_wrapper::buffer_texture faces;
+        gl_wrapper::buffer_texture translucent;
+        GLsizei quad_count;
+        GLsizei translucent_quad_count;
+        size_t bytes;
+        glm::vec3 origin;
+        glm::mat4 model;
+
+        // Unsorted copy of the translucent faces, for sorting again
+        std::vector<uint32_t> translucent_faces;
+    };
+
+    // Quantized distance from the eye, for sorting the draw lists
+    struct draw_item {
+        uint16_t key;
+        section_mesh *mesh;
+    };
+
+    void select_programs(uint32_t features, bool overdraw);
+    void draw_depth(const arena_vector<draw_item>& draw_list, const glm::mat4& view);
+    void draw_cascade(int cascade);
+    void set_shadow_uniforms(gl_wrapper::shader_program& program);
+
+    void upload(const section_coord& coord,
+                const std::vector<uint32_t>& faces,
+                const std::vector<uint32_t>& translucent_faces);
+    void remove(const section_coord& coord);
+    std::unique_ptr<section_mesh> take_spare(size_t bytes);
+    void load_faces(gl_wrapper::buffer_texture& buffer, const std::vector<uint32_t>& faces);
+
+    void update_eye(const glm::vec3& eye);
+    void sort_translucent(section_mesh& s);
+    void draw_translucent(const arena_vector<draw_item>& translucent_list, const glm::mat4& view);
+    void draw_quads(GLsizei quad_count);
+
+    shader_cache m_shaders;
+    gl_wrapper::shader_program *m_shader_program;
+    gl_wrapper::shader_program *m_translucent_program;
+    gl_wrapper::shader_program *m_depth_program;
+    gl_wrapper::shader_program *m_caster_program;
+    uint32_t m_features;
+    bool m_depth_prepass;
+    bool m_overdraw;
+    glm::mat4 m_projection;
+    gl_wrapper::texture m_texture;
+    gl_wrapper::texture m_translucent_texture;
+    shadow_cascades m_shadows;
+
+    // Indices for mesher::max_quads quads, shared by every section
+    gl_wrapper::vao m_vao;
+    gl_wrapper::ebo m_quad_indices;
+
+    std::unordered_map<section_coord,
+                       std::unique_ptr<section_mesh>,
+                       chunk_coord_hash> m_sections;
+    std::vector<std::unique_ptr<section_mesh>> m_spare;
+
+    // Where the translucent faces were last sorted from
+    bool m_eye_valid;
+    glm::vec3 m_eye;
+    chunk_coord m_eye_chunk;
+
+    mesher m_mesher;
+    std::vector<uint32_t> m_faces;
+    std::vector<uint32_t> m_translucent_faces;
+    std::vector<section_coord> m_dirty;
+    std::vector<std::pair<float, uint32_t>> m_sort_keys;
+    std::vector<uint32_t> m_sorted_faces;
+    render_stats m_stats;
+
+    static const std::string m_vertex_shader_filename;
+    static const std::string m_fragment_shader_filename;
+    static const std::string m_texture_filename;
+    static const std::string m_translucent_texture_filename;
+};
+
+#endif // CHUNK_RENDERER_HPP
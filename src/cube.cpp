@@ -1,109 +1,57 @@
 // Module Header
 #include "cube.hpp"
 
-// External Headers
-#include <glad/glad.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+// Local Headers
+#include "chunk.hpp"
 
-// C++ Standard Headers
-#include <string>
-
-using namespace std;
-
-static void enable_vertex_attrib()
-{
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-}
-
-static void enable_texture_attrib()
-{
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-}
+// Offset of each face's vertices in m_vertex_data, indexed by face
+static const int s_face_start[face_count] = {
+    2, 3, 4, 5, 0, 1
+};
 
-cube::cube() :
-    m_shader_program(m_vertex_shader_filename, m_fragment_shader_filename),
-    m_texture(m_texture_filename, false)
+const float *cube::face_vertices(face f)
 {
-    m_vao.bind();
-    m_vbo.bind();
-
-    m_vbo.load(m_vertex_data, sizeof(m_vertex_data));
-
-    enable_vertex_attrib();
-    enable_texture_attrib();
-
-    m_shader_program.use();
-    m_shader_program.set_uniformi("texture0", 0);
+    int start = s_face_start[static_cast<int>(f)];
+    return &m_vertex_data[start * face_corner_count * vertex_floats];
 }
 
-void cube::set_projection(const glm::mat4& projection_mat)
+const float *cube::face_corner(face f, int corner)
 {
-    m_projection = projection_mat;
-    m_shader_program.set_uniform4fv("projection",
-                                    glm::value_ptr(projection_mat));
+    return face_vertices(f) + corner * vertex_floats;
 }
 
-void cube::draw(const glm::mat4& model, const glm::mat4& view)
-{
-    m_vao.bind();
-    m_shader_program.use();
-    glActiveTexture(GL_TEXTURE0);
-    m_texture.bind();
-
-    m_shader_program.set_uniform4fv("model", glm::value_ptr(model));
-    m_shader_program.set_uniform4fv("view", glm::value_ptr(view));
-
-    glDrawArrays(GL_TRIANGLES, 0, sizeof(m_vertex_data));
-}
+const uint16_t cube::quad_indices[face_index_count] = {
+    0, 1, 2, 2, 3, 0
+};
 
 const float cube::m_vertex_data[] = {
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+    0.0f, 0.0f, 0.0f,  0.0f, 0.0f,
+    1.0f, 0.0f, 0.0f,  1.0f, 0.0f,
+    1.0f, 1.0f, 0.0f,  1.0f, 1.0f,
+    0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
+
+    0.0f, 0.0f, 1.0f,  0.0f, 0.0f,
+    1.0f, 0.0f, 1.0f,  1.0f, 0.0f,
+    1.0f, 1.0f, 1.0f,  1.0f, 1.0f,
+    0.0f, 1.0f, 1.0f,  0.0f, 1.0f,
+
+    0.0f, 1.0f, 1.0f,  1.0f, 0.0f,
+    0.0f, 1.0f, 0.0f,  1.0f, 1.0f,
+    0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+    0.0f, 0.0f, 1.0f,  0.0f, 0.0f,
+
+    1.0f, 1.0f, 1.0f,  1.0f, 0.0f,
+    1.0f, 1.0f, 0.0f,  1.0f, 1.0f,
+    1.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+    1.0f, 0.0f, 1.0f,  0.0f, 0.0f,
+
+    0.0f, 0.0f, 0.0f,  0.0f, 1.0f,
+    1.0f, 0.0f, 0.0f,  1.0f, 1.0f,
+    1.0f, 0.0f, 1.0f,  1.0f, 0.0f,
+    0.0f, 0.0f, 1.0f,  0.0f, 0.0f,
+
+    0.0f, 1.0f, 0.0f,  0.0f, 1.0f,
+    1.0f, 1.0f, 0.0f,  1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f,  1.0f, 0.0f,
+    0.0f, 1.0f, 1.0f,  0.0f, 0.0f
 };
-
-const string cube::m_vertex_shader_filename = "cube_vert.glsl";
-const string cube::m_fragment_shader_filename = "cube_frag.glsl";
-const string cube::m_texture_filename = "container.jpg";
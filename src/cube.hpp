@@ -2,39 +2,40 @@
 #define CUBE_HPP
 
 // Local Headers
-#include "gl_wrapper.hpp"
+#include "chunk.hpp"
 
-// External Headers
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-
-// C++ Standard Headers
-#include <string>
+// C Standard Headers
+#include <cstdint>
 
 enum class cube_texture {
     crate
 };
 
+/**
+ *  Geometry of a unit voxel, four corners per face
+ *
+ *  Each vertex is a position in [0, 1]^3 followed by a texture
+ *  coordinate.  The mesher shades faces by these corners, and the vertex
+ *  shader (cube_vert.glsl) has a copy to build each face from.
+ *  face_corner() returns a face's corners in order around the quad, and
+ *  quad_indices splits a quad into two triangles along its 0-2
+ *  diagonal; emitting the corners starting from corner 1 instead splits
+ *  along 1-3 with the same indices.
+ */
 class cube {
  public:
-    cube();
+    static const int face_corner_count = 4;
+    static const int face_index_count = 6;
+    static const int vertex_floats = 5;
 
-    void set_projection(const glm::mat4& projection_mat);
+    static const uint16_t quad_indices[face_index_count];
 
-    void draw(const glm::mat4& model, const glm::mat4& view);
+    static const float *face_vertices(face f);
+    static const float *face_corner(face f, int corner);
 
  private:
-    gl_wrapper::vao m_vao;
-    gl_wrapper::vbo m_vbo;
-    gl_wrapper::shader_program m_shader_program;
-    gl_wrapper::texture m_texture;
-    glm::mat4 m_projection;
-
-    static const int m_vertex_count = 36;
-    static const float m_vertex_data[m_vertex_count * 5];
-    static const std::string m_vertex_shader_filename;
-    static const std::string m_fragment_shader_filename;
-    static const std::string m_texture_filename;
+    static const int m_vertex_count = 24;
+    static const float m_vertex_data[m_vertex_count * vertex_floats];
 };
 
 #endif // CUBE_HPP
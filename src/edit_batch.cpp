@@ -0,0 +1,130 @@
+// Module Header
+#include "edit_batch.hpp"
+
+// Local Headers
+#include "trace.hpp"
+
+// C++ Standard Headers
+#include <vector>
+
+using namespace std;
+
+edit_batch::edit_batch() :
+    m_size(0)
+{
+}
+
+void edit_batch::set_block(int x, int y, int z, block b)
+{
+    chunk_coord coord = world::chunk_of(x, y, z);
+    int index = chunk::index(floor_mod(x, chunk::size),
+                             floor_mod(y, chunk::size),
+                             floor_mod(z, chunk::size));
+
+    m_edits[coord].push_back(edit{static_cast<uint16_t>(index), b});
+    m_size++;
+}
+
+void edit_batch::fill(int x0, int y0, int z0, int x1, int y1, int z1, block b)
+{
+    for (int y = y0; y <= y1; y++) {
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                set_block(x, y, z, b);
+            }
+        }
+    }
+}
+
+void edit_batch::sphere(int cx, int cy, int cz, int radius, block b)
+{
+    int r2 = radius * radius;
+    for (int y = -radius; y <= radius; y++) {
+        for (int z = -radius; z <= radius; z++) {
+            for (int x = -radius; x <= radius; x++) {
+                if (x * x + y * y + z * z <= r2) {
+                    set_block(cx + x, cy + y, cz + z, b);
+                }
+            }
+        }
+    }
+}
+
+size_t edit_batch::size() const
+{
+    return m_size;
+}
+
+bool edit_batch::empty() const
+{
+    return m_size == 0;
+}
+
+void edit_batch::clear()
+{
+    m_edits.clear();
+    m_size = 0;
+}
+
+void edit_batch::commit(world& w, worker_pool& pool)
+{
+    TRACE_SCOPE("edit batch");
+    // Chunk creation touches the world's map, so it happens up front on
+    // this thread; the jobs themselves only write to their own chunk.
+    m_jobs.clear();
+    for (const auto& entry : m_edits) {
+        chunk *target = w.find_chunk(entry.first);
+        if (target == nullptr) {
+            bool all_air = true;
+            for (const edit& e : entry.second) {
+                if (e.b != block::air) {
+                    all_air = false;
+                    break;
+                }
+            }
+            if (all_air) {
+                continue;
+            }
+            target = &w.get_or_create_chunk(entry.first);
+        }
+
+        m_jobs.push_back(job{entry.first, target, &entry.second, 0, {}});
+    }
+
+    pool.parallel_for(m_jobs.size(), [this](size_t i) {
+        TRACE_SCOPE("edit chunk");
+        job& j = m_jobs[i];
+        j.dirty_mask = apply(*j.target, *j.edits, j.changed);
+    });
+
+    for (const job& j : m_jobs) {
+        w.mark_sections_dirty(j.coord, j.dirty_mask);
+        for (uint16_t index : j.changed) {
+            w.note_block_change(j.coord, index);
+        }
+    }
+
+    clear();
+}
+
+uint64_t edit_batch::apply(chunk& c,
+                           const vector<edit>& edits,
+                           vector<uint16_t>& changed)
+{
+    uint64_t mask = 0;
+
+    for (const edit& e : edits) {
+        int x = e.index % chunk::size;
+        int z = (e.index / chunk::size) % chunk::size;
+        int y = e.index / (chunk::size * chunk::size);
+
+        if (!c.set(x, y, z, e.b)) {
+            continue;
+        }
+
+        mask |= world::border_sections(x, y, z);
+        changed.push_back(e.index);
+    }
+
+    return mask;
+}
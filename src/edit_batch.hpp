@@ -0,0 +1,65 @@
+#ifndef EDIT_BATCH_HPP
+#define EDIT_BATCH_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "world.hpp"
+#include "worker_pool.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <unordered_map>
+#include <vector>
+
+/**
+ *  Accumulates many block writes and applies them to a world in one go
+ *
+ *  Writes are bucketed by chunk as they are recorded.  commit() applies
+ *  each chunk's bucket as an independent job on a worker_pool and then
+ *  marks every touched section dirty exactly once, instead of paying for
+ *  dirty tracking on every voxel as world::set_block() does.  Later
+ *  writes to the same block win.
+ */
+class edit_batch {
+ public:
+    edit_batch();
+
+    void set_block(int x, int y, int z, block b);
+    void fill(int x0, int y0, int z0, int x1, int y1, int z1, block b);
+    void sphere(int cx, int cy, int cz, int radius, block b);
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    void commit(world& w, worker_pool& pool);
+
+ private:
+    struct edit {
+        uint16_t index;
+        block b;
+    };
+
+    struct job {
+        chunk_coord coord;
+        chunk *target;
+        const std::vector<edit> *edits;
+        uint64_t dirty_mask;
+        std::vector<uint16_t> changed;
+    };
+
+    static uint64_t apply(chunk& c,
+                          const std::vector<edit>& edits,
+                          std::vector<uint16_t>& changed);
+
+    std::unordered_map<chunk_coord,
+                       std::vector<edit>,
+                       chunk_coord_hash> m_edits;
+    size_t m_size;
+    std::vector<job> m_jobs;
+};
+
+#endif // EDIT_BATCH_HPP
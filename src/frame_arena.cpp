@@ -0,0 +1,82 @@
+// Module Header
+#include "frame_arena.hpp"
+
+// C Standard Headers
+#include <cstdint>
+#include <cstdlib>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+// Overflow blocks a frame can hold before the list itself must grow
+static const size_t s_overflow_reserve = 64;
+
+frame_arena::frame_arena(size_t capacity) :
+    m_block(new unsigned char[capacity]),
+    m_capacity(capacity),
+    m_used(0),
+    m_high_water(0),
+    m_overflow_count(0)
+{
+    m_overflow.reserve(s_overflow_reserve);
+}
+
+frame_arena::~frame_arena()
+{
+    reset();
+}
+
+void *frame_arena::allocate(size_t size, size_t align)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+    uintptr_t start = (base + m_used + align - 1) & ~(uintptr_t)(align - 1);
+    size_t end = start - base + size;
+
+    m_high_water = max(m_high_water, end);
+    if (end <= m_capacity) {
+        m_used = end;
+        return reinterpret_cast<void *>(start);
+    }
+
+    // Out of room: take it from the heap until the end of the frame
+    size_t alignment = max(align, sizeof(void *));
+    void *p = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    m_overflow.push_back(p);
+    m_overflow_count++;
+    return p;
+}
+
+void frame_arena::reset()
+{
+    for (void *p : m_overflow) {
+        free(p);
+    }
+    m_overflow.clear();
+    m_used = 0;
+}
+
+size_t frame_arena::used() const
+{
+    return m_used;
+}
+
+size_t frame_arena::capacity() const
+{
+    return m_capacity;
+}
+
+size_t frame_arena::high_water() const
+{
+    return m_high_water;
+}
+
+size_t frame_arena::overflow_count() const
+{
+    return m_overflow_count;
+}
@@ -0,0 +1,94 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+// C Standard Headers
+#include <cstddef>
+
+// C++ Standard Headers
+#include <memory>
+#include <vector>
+
+/**
+ *  Linear allocator for data that only lives until the end of a frame
+ *
+ *  allocate() bumps an offset into one block reserved up front and
+ *  reset() releases everything at once, so transient lists cost no heap
+ *  traffic.  Requests that do not fit are served from the heap and
+ *  counted as overflows; high_water() shows how big the block needs to
+ *  be.  Memory is never returned individually, so containers in the
+ *  arena should reserve() rather than grow step by step.
+ */
+class frame_arena {
+ public:
+    explicit frame_arena(size_t capacity);
+    ~frame_arena();
+
+    frame_arena(const frame_arena&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+
+    void *allocate(size_t size, size_t align);
+    void reset();
+
+    size_t used() const;
+    size_t capacity() const;
+    size_t high_water() const;
+    size_t overflow_count() const;
+
+ private:
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_capacity;
+    size_t m_used;
+    size_t m_high_water;
+
+    std::vector<void *> m_overflow;
+    size_t m_overflow_count;
+};
+
+/**
+ *  Standard allocator drawing from a frame_arena, for containers that are
+ *  rebuilt every frame (see arena_vector)
+ */
+template <typename T>
+class arena_allocator {
+ public:
+    typedef T value_type;
+
+    explicit arena_allocator(frame_arena& arena) : m_arena(&arena) {}
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) : m_arena(other.arena()) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t)
+    {
+    }
+
+    frame_arena *arena() const
+    {
+        return m_arena;
+    }
+
+ private:
+    frame_arena *m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>& a, const arena_allocator<U>& b)
+{
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>& a, const arena_allocator<U>& b)
+{
+    return a.arena() != b.arena();
+}
+
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+#endif // FRAME_ARENA_HPP
@@ -0,0 +1,29 @@
+// Module Header
+#include "frame_clock.hpp"
+
+// C++ Standard Headers
+#include <chrono>
+
+using namespace std;
+
+frame_clock::frame_clock() :
+    m_start(clock::now()),
+    m_last(m_start)
+{
+}
+
+// Seconds since the previous tick (or construction)
+float frame_clock::tick()
+{
+    clock::time_point now = clock::now();
+    chrono::duration<float> delta = now - m_last;
+    m_last = now;
+    return delta.count();
+}
+
+// Seconds since construction
+double frame_clock::elapsed() const
+{
+    chrono::duration<double> total = clock::now() - m_start;
+    return total.count();
+}
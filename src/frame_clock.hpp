@@ -0,0 +1,25 @@
+#ifndef FRAME_CLOCK_HPP
+#define FRAME_CLOCK_HPP
+
+// C++ Standard Headers
+#include <chrono>
+
+/**
+ *  Measures the time between frames with a monotonic high resolution
+ *  clock, in seconds
+ */
+class frame_clock {
+ public:
+    frame_clock();
+
+    float tick();
+    double elapsed() const;
+
+ private:
+    typedef std::chrono::steady_clock clock;
+
+    clock::time_point m_start;
+    clock::time_point m_last;
+};
+
+#endif // FRAME_CLOCK_HPP
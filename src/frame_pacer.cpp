@@ -0,0 +1,58 @@
+// Module Header
+#include "frame_pacer.hpp"
+
+// C++ Standard Headers
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+// Time before a deadline where sleeping stops and spinning takes over
+static const chrono::microseconds s_spin_margin(1500);
+
+frame_pacer::frame_pacer(float frames_per_second) :
+    m_rate(0),
+    m_period(0),
+    m_deadline(clock::now())
+{
+    set_rate(frames_per_second);
+}
+
+void frame_pacer::set_rate(float frames_per_second)
+{
+    m_rate = frames_per_second > 0 ? frames_per_second : 0;
+    if (m_rate > 0) {
+        chrono::duration<double> period(1.0 / m_rate);
+        m_period = chrono::duration_cast<clock::duration>(period);
+    } else {
+        m_period = clock::duration(0);
+    }
+    m_deadline = clock::now() + m_period;
+}
+
+float frame_pacer::rate() const
+{
+    return m_rate;
+}
+
+void frame_pacer::wait()
+{
+    if (m_rate <= 0) {
+        return;
+    }
+
+    clock::time_point now = clock::now();
+    if (now - m_deadline > m_period) {
+        m_deadline = now + m_period;
+        return;
+    }
+
+    if (m_deadline - now > s_spin_margin) {
+        this_thread::sleep_until(m_deadline - s_spin_margin);
+    }
+    while (clock::now() < m_deadline) {
+        this_thread::yield();
+    }
+
+    m_deadline += m_period;
+}
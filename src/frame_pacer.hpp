@@ -0,0 +1,34 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+// C++ Standard Headers
+#include <chrono>
+
+/**
+ *  Holds frames to a fixed rate without relying on vsync
+ *
+ *  wait() blocks until the next frame is due: it sleeps through most of
+ *  the gap, then spins for the last stretch, since sleeps routinely
+ *  overshoot by a scheduler tick.  Deadlines advance by exactly one
+ *  period so the average rate stays on target; after falling more than
+ *  a frame behind the schedule restarts from now instead of rushing to
+ *  catch up.  A rate of zero disables pacing.
+ */
+class frame_pacer {
+ public:
+    explicit frame_pacer(float frames_per_second = 0);
+
+    void set_rate(float frames_per_second);
+    float rate() const;
+
+    void wait();
+
+ private:
+    typedef std::chrono::steady_clock clock;
+
+    float m_rate;
+    clock::duration m_period;
+    clock::time_point m_deadline;
+};
+
+#endif // FRAME_PACER_HPP
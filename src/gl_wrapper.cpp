@@ -4,22 +4,27 @@
 
 // C Standard Headers
 #include <cassert>
+#include <cctype>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 
 // C++ Standard Headers
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 
 using namespace std;
 
-// TODO: We aren't checking OpenGL's error status in a number of places.
-// We should use the debug facility and then bind a callback to generate
-// exceptions on openGL errors; this will enable more of the construtors
-// to fail when an error is generated.
+// OpenGL errors are only checked when a strict debug_output is active:
+// its callback flags errors, and the operations below that can fail
+// inside the driver (buffer uploads, shader builds, textures) check the
+// flag and throw their exception.  Otherwise checks cost nothing.
 
 namespace gl_wrapper {
 
@@ -72,6 +77,68 @@ class gl_image_open_exception: public exception {
     }
 } image_ex;
 
+class gl_shader_include_exception: public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error reading shader source or include.";
+    }
+} include_ex;
+
+class gl_buffer_load_exception: public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error loading buffer data.";
+    }
+} buffer_load_ex;
+
+class gl_texture_exception: public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error creating texture.";
+    }
+} texture_ex;
+
+class gl_framebuffer_exception: public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error creating framebuffer.";
+    }
+} framebuffer_ex;
+
+class gl_error_exception: public exception {
+    virtual const char* what() const throw()
+    {
+        return "OpenGL reported an error.";
+    }
+} gl_error_ex;
+
+// KHR_debug enums, which the GL 3.3 core loader does not define
+static const GLenum s_debug_output = 0x92E0;
+static const GLenum s_debug_output_synchronous = 0x8242;
+static const GLenum s_debug_type_error = 0x824C;
+static const GLenum s_debug_type_performance = 0x8250;
+static const GLenum s_debug_severity_high = 0x9146;
+static const GLenum s_debug_severity_medium = 0x9147;
+static const GLenum s_debug_severity_low = 0x9148;
+static const GLenum s_debug_severity_notification = 0x826B;
+
+// Distinct messages remembered for the summary; later ones are counted
+// by type and as untracked only
+static const size_t s_max_tracked_messages = 256;
+
+// Buffer texture stores grow in steps of this many bytes
+static const GLsizeiptr s_buffer_page = 4096;
+
+static debug_output *s_debug = nullptr;
+
+// Binds and uniform updates made so far; see binds_and_uniforms()
+static uint64_t s_binds_and_uniforms = 0;
+
+static bool gl_failed()
+{
+    return s_debug != nullptr && s_debug->take_error();
+}
+
 vao::vao()
 {
     glGenVertexArrays(1, &m_handle);
@@ -84,6 +151,7 @@ vao::~vao()
 
 void vao::bind()
 {
+    s_binds_and_uniforms++;
     glBindVertexArray(m_handle);
 }
 
@@ -100,17 +168,21 @@ vbo::~vbo()
 
 void vbo::bind()
 {
+    s_binds_and_uniforms++;
     glBindBuffer(GL_ARRAY_BUFFER, m_handle);
 }
 
-void vbo::load(const GLvoid *data, GLsizeiptr size)
+void vbo::load(const GLvoid *data, GLsizeiptr size, GLenum usage)
 {
     if (data == nullptr) {
         throw buf_null;
     }
 
     bind();
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+    if (gl_failed()) {
+        throw buffer_load_ex;
+    }
 }
 
 ebo::ebo()
@@ -125,6 +197,7 @@ ebo::~ebo()
 
 void ebo::bind()
 {
+    s_binds_and_uniforms++;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_handle);
 }
 
@@ -136,6 +209,63 @@ void ebo::load(const GLvoid * data, GLsizeiptr size)
 
     bind();
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    if (gl_failed()) {
+        throw buffer_load_ex;
+    }
+}
+
+buffer_texture::buffer_texture(GLenum internal_format) :
+    m_internal_format(internal_format),
+    m_capacity(0)
+{
+    glGenBuffers(1, &m_buffer);
+    glGenTextures(1, &m_texture);
+}
+
+buffer_texture::~buffer_texture()
+{
+    glDeleteTextures(1, &m_texture);
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void buffer_texture::bind()
+{
+    s_binds_and_uniforms++;
+    glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+}
+
+void buffer_texture::load(const GLvoid *data, GLsizeiptr size)
+{
+    if (data == nullptr) {
+        throw buf_null;
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+    if (size <= m_capacity) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        if (gl_failed()) {
+            throw buffer_load_ex;
+        }
+        return;
+    }
+
+    GLsizeiptr capacity = (size + s_buffer_page - 1) / s_buffer_page * s_buffer_page;
+    glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+
+    // Attaching again after the store is replaced is harmless
+    bind();
+    glTexBuffer(GL_TEXTURE_BUFFER, m_internal_format, m_buffer);
+    if (gl_failed()) {
+        m_capacity = 0;
+        throw buffer_load_ex;
+    }
+    m_capacity = capacity;
+}
+
+GLsizeiptr buffer_texture::capacity() const
+{
+    return m_capacity;
 }
 
 shader::shader(GLenum shader_type)
@@ -162,19 +292,33 @@ shader::~shader()
     glDeleteShader(m_handle);
 }
 
-void shader::compile(const string& filename)
+void shader::compile(const string& filename,
+                     const vector<string>& defines,
+                     vector<string>& files)
 {
     assert(m_handle != 0);
 
-    string source = read_shader_source(filename);
+    // Numbered as the #line directives number them
+    vector<string> stage_files;
+    string source = preprocess_shader(filename, defines, stage_files);
     const char* source_str = source.c_str();
     glShaderSource(m_handle, 1, &source_str, NULL);
     glCompileShader(m_handle);
 
-    if (!compile_success()) {
+    if (!compile_success() || gl_failed()) {
+        for (size_t i = 0; i < stage_files.size(); i++) {
+            printf("%zu = %s\n", i, stage_files[i].c_str());
+        }
         print_compile_msg();
         throw compile_ex;
     }
+
+    // The program's list is only for watching, so each file once
+    for (const string& file : stage_files) {
+        if (find(files.begin(), files.end(), file) == files.end()) {
+            files.push_back(file);
+        }
+    }
 }
 
 bool shader::compile_success()
@@ -196,7 +340,7 @@ void shader::print_compile_msg()
 
     char msg_buf[512];
 
-    glGetProgramInfoLog(m_handle, 512, NULL, msg_buf);
+    glGetShaderInfoLog(m_handle, 512, NULL, msg_buf);
     printf("%s\n", msg_buf);
 }
 
@@ -227,7 +371,7 @@ void program::link(GLuint vertex_shader, GLuint fragment_shader)
 
     int status;
     glGetProgramiv(m_handle, GL_LINK_STATUS, &status);
-    if (status == 0) {
+    if (status == 0 || gl_failed()) {
         char log[512];
         glGetProgramInfoLog(m_handle, 512, NULL, log);
         printf("%s\n", log);
@@ -236,17 +380,22 @@ void program::link(GLuint vertex_shader, GLuint fragment_shader)
 }
 
 shader_program::shader_program(const string& vertex_filename,
-                               const string& fragment_filename) :
+                               const string& fragment_filename,
+                               const vector<string>& defines) :
     m_vertex_shader(GL_VERTEX_SHADER),
-    m_fragment_shader(GL_FRAGMENT_SHADER)
+    m_fragment_shader(GL_FRAGMENT_SHADER),
+    m_vertex_filename(vertex_filename),
+    m_fragment_filename(fragment_filename),
+    m_defines(defines)
 {
-    m_vertex_shader.compile(vertex_filename);
-    m_fragment_shader.compile(fragment_filename);
+    m_vertex_shader.compile(vertex_filename, m_defines, m_files);
+    m_fragment_shader.compile(fragment_filename, m_defines, m_files);
     m_program.link(m_vertex_shader.m_handle, m_fragment_shader.m_handle);
 }
 
 void shader_program::use()
 {
+    s_binds_and_uniforms++;
     glUseProgram(m_program.handle());
 }
 
@@ -257,20 +406,124 @@ GLuint shader_program::handle()
 
 void shader_program::set_uniformi(const string& name, int value)
 {
-    int loc = glGetUniformLocation(m_program.handle(), name.c_str());
-    glUniform1i(loc, value);
+    s_binds_and_uniforms++;
+    uniform& u = find_uniform(name, GL_INT);
+    u.int_value = value;
+    glUniform1i(u.location, value);
 }
 
 void shader_program::set_uniformf(const string& name, float value)
 {
-    int loc = glGetUniformLocation(m_program.handle(), name.c_str());
-    glUniform1f(loc, value);
+    s_binds_and_uniforms++;
+    uniform& u = find_uniform(name, GL_FLOAT);
+    u.value[0] = value;
+    glUniform1f(u.location, value);
+}
+
+void shader_program::set_uniform2f(const string& name, float x, float y)
+{
+    s_binds_and_uniforms++;
+    uniform& u = find_uniform(name, GL_FLOAT_VEC2);
+    u.value[0] = x;
+    u.value[1] = y;
+    glUniform2f(u.location, x, y);
+}
+
+void shader_program::set_uniform3f(const string& name, float x, float y, float z)
+{
+    s_binds_and_uniforms++;
+    uniform& u = find_uniform(name, GL_FLOAT_VEC3);
+    u.value[0] = x;
+    u.value[1] = y;
+    u.value[2] = z;
+    glUniform3f(u.location, x, y, z);
 }
 
 void shader_program::set_uniform4fv(const string& name, const float *value)
 {
-    int loc = glGetUniformLocation(m_program.handle(), name.c_str());
-    glUniformMatrix4fv(loc, 1, GL_FALSE, value);
+    s_binds_and_uniforms++;
+    uniform& u = find_uniform(name, GL_FLOAT_MAT4);
+    copy(value, value + 16, u.value);
+    glUniformMatrix4fv(u.location, 1, GL_FALSE, value);
+}
+
+bool shader_program::reload()
+{
+    // Built beside the current program; the handles are only swapped
+    // once it has linked, and the old ones die with these locals
+    shader vertex_shader(GL_VERTEX_SHADER);
+    shader fragment_shader(GL_FRAGMENT_SHADER);
+    program new_program;
+    vector<string> files;
+    try {
+        vertex_shader.compile(m_vertex_filename, m_defines, files);
+        fragment_shader.compile(m_fragment_filename, m_defines, files);
+        new_program.link(vertex_shader.m_handle, fragment_shader.m_handle);
+    } catch (const exception& e) {
+        fprintf(stderr, "Reload of %s + %s failed (%s); keeping the old program\n",
+                m_vertex_filename.c_str(), m_fragment_filename.c_str(), e.what());
+        return false;
+    }
+
+    swap(m_vertex_shader.m_handle, vertex_shader.m_handle);
+    swap(m_fragment_shader.m_handle, fragment_shader.m_handle);
+    swap(m_program.m_handle, new_program.m_handle);
+    m_files.swap(files);
+
+    // Locations may differ in the new program, and it starts with every
+    // uniform at zero
+    GLint previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    use();
+    for (auto& entry : m_uniforms) {
+        uniform& u = entry.second;
+        u.location = glGetUniformLocation(m_program.handle(), entry.first.c_str());
+        apply(u);
+    }
+    glUseProgram(previous == (GLint)new_program.m_handle ? m_program.handle() : previous);
+
+    printf("Reloaded %s + %s\n", m_vertex_filename.c_str(), m_fragment_filename.c_str());
+    return true;
+}
+
+const string& shader_program::vertex_filename() const
+{
+    return m_vertex_filename;
+}
+
+const string& shader_program::fragment_filename() const
+{
+    return m_fragment_filename;
+}
+
+const vector<string>& shader_program::source_files() const
+{
+    return m_files;
+}
+
+shader_program::uniform& shader_program::find_uniform(const string& name, GLenum type)
+{
+    auto it = m_uniforms.find(name);
+    if (it == m_uniforms.end()) {
+        uniform u = {};
+        u.location = glGetUniformLocation(m_program.handle(), name.c_str());
+        it = m_uniforms.emplace(name, u).first;
+    }
+
+    it->second.type = type;
+    return it->second;
+}
+
+void shader_program::apply(const uniform& u)
+{
+    switch (u.type) {
+        case GL_INT:        glUniform1i(u.location, u.int_value); break;
+        case GL_FLOAT:      glUniform1f(u.location, u.value[0]); break;
+        case GL_FLOAT_VEC2: glUniform2f(u.location, u.value[0], u.value[1]); break;
+        case GL_FLOAT_VEC3: glUniform3f(u.location, u.value[0], u.value[1], u.value[2]); break;
+        case GL_FLOAT_MAT4: glUniformMatrix4fv(u.location, 1, GL_FALSE, u.value); break;
+        default:            break;
+    }
 }
 
 image::image(const string& image_filename)
@@ -323,7 +576,7 @@ texture::texture(const string& image_filename, bool has_alpha) :
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB,
+    glTexImage2D(GL_TEXTURE_2D, 0, has_alpha ? GL_RGBA : GL_RGB,
                  m_image.width(),
                  m_image.height(),
                  0,
@@ -331,13 +584,369 @@ texture::texture(const string& image_filename, bool has_alpha) :
                  GL_UNSIGNED_BYTE,
                  m_image.data());
     glGenerateMipmap(GL_TEXTURE_2D);
+    if (gl_failed()) {
+        throw texture_ex;
+    }
 }
 
 void texture::bind()
 {
+    s_binds_and_uniforms++;
     glBindTexture(GL_TEXTURE_2D, m_handle);
 }
 
+mask_texture::mask_texture(int width, int height, const uint8_t *pixels)
+{
+    glGenTextures(1, &m_handle);
+    bind();
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Rows are tightly packed bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (gl_failed()) {
+        throw texture_ex;
+    }
+}
+
+mask_texture::~mask_texture()
+{
+    glDeleteTextures(1, &m_handle);
+}
+
+void mask_texture::bind()
+{
+    s_binds_and_uniforms++;
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+}
+
+depth_texture_array::depth_texture_array(int size, int layers) :
+    m_framebuffers(layers, 0),
+    m_size(size)
+{
+    glGenTextures(1, &m_texture);
+    bind();
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, size, size, layers, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    if (gl_failed()) {
+        glDeleteTextures(1, &m_texture);
+        throw texture_ex;
+    }
+
+    // Depth only; no colour buffer is drawn to or read from
+    glGenFramebuffers(layers, m_framebuffers.data());
+    bool complete = true;
+    for (int layer = 0; layer < layers; layer++) {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[layer]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_texture, 0, layer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete || gl_failed()) {
+        glDeleteFramebuffers(layers, m_framebuffers.data());
+        glDeleteTextures(1, &m_texture);
+        throw framebuffer_ex;
+    }
+}
+
+depth_texture_array::~depth_texture_array()
+{
+    glDeleteFramebuffers(static_cast<GLsizei>(m_framebuffers.size()), m_framebuffers.data());
+    glDeleteTextures(1, &m_texture);
+}
+
+void depth_texture_array::bind()
+{
+    s_binds_and_uniforms++;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+}
+
+void depth_texture_array::bind_layer(int layer)
+{
+    s_binds_and_uniforms++;
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[layer]);
+    glViewport(0, 0, m_size, m_size);
+}
+
+int depth_texture_array::size() const
+{
+    return m_size;
+}
+
+int depth_texture_array::layers() const
+{
+    return static_cast<int>(m_framebuffers.size());
+}
+
+static bool has_extension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const GLubyte *ext = glGetStringi(GL_EXTENSIONS, i);
+        if (ext != nullptr && strcmp((const char *)ext, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static const char *severity_name(GLenum severity)
+{
+    switch (severity) {
+        case s_debug_severity_high:         return "high";
+        case s_debug_severity_medium:       return "medium";
+        case s_debug_severity_low:          return "low";
+        case s_debug_severity_notification: return "info";
+        default:                            return "unknown";
+    }
+}
+
+static debug_severity to_severity(GLenum severity)
+{
+    switch (severity) {
+        case s_debug_severity_high:     return debug_severity::high;
+        case s_debug_severity_medium:   return debug_severity::medium;
+        case s_debug_severity_low:      return debug_severity::low;
+        default:                        return debug_severity::notification;
+    }
+}
+
+debug_output::debug_output(load_proc load, debug_severity min_severity, bool strict) :
+    m_control(nullptr),
+    m_available(false),
+    m_strict(strict),
+    m_min_severity(min_severity),
+    m_errors(0),
+    m_performance(0),
+    m_stalls(0),
+    m_recompiles(0),
+    m_other(0),
+    m_untracked(0),
+    m_error_pending(false)
+{
+    typedef void (APIENTRYP callback_proc)(GLDEBUGPROC, const void *);
+    callback_proc set_callback = nullptr;
+
+    // Core names from GL 4.3 or KHR_debug, else the older ARB extension
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 3) || has_extension("GL_KHR_debug")) {
+        set_callback = (callback_proc)load("glDebugMessageCallback");
+        m_control = (control_proc)load("glDebugMessageControl");
+    } else if (has_extension("GL_ARB_debug_output")) {
+        set_callback = (callback_proc)load("glDebugMessageCallbackARB");
+        m_control = (control_proc)load("glDebugMessageControlARB");
+    }
+
+    s_debug = this;
+    m_available = set_callback != nullptr && m_control != nullptr;
+    if (!m_available) {
+        return;
+    }
+
+    glEnable(s_debug_output);
+    if (m_strict) {
+        glEnable(s_debug_output_synchronous);
+    }
+    set_callback(callback, this);
+    set_min_severity(min_severity);
+}
+
+debug_output::~debug_output()
+{
+    if (m_available) {
+        glDisable(s_debug_output);
+    }
+    s_debug = nullptr;
+}
+
+bool debug_output::available() const
+{
+    return m_available;
+}
+
+void debug_output::set_min_severity(debug_severity severity)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_min_severity = severity;
+    }
+    if (!m_available) {
+        return;
+    }
+
+    static const GLenum levels[] = {
+        s_debug_severity_notification,
+        s_debug_severity_low,
+        s_debug_severity_medium,
+        s_debug_severity_high
+    };
+
+    for (GLenum level : levels) {
+        GLboolean enable = to_severity(level) >= severity ? GL_TRUE : GL_FALSE;
+        m_control(GL_DONT_CARE, GL_DONT_CARE, level, 0, nullptr, enable);
+    }
+
+    // Performance warnings are counted whatever their severity
+    m_control(GL_DONT_CARE, s_debug_type_performance, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+}
+
+size_t debug_output::error_count() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_errors;
+}
+
+size_t debug_output::performance_count() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_performance;
+}
+
+size_t debug_output::stall_count() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_stalls;
+}
+
+size_t debug_output::recompile_count() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_recompiles;
+}
+
+void debug_output::print_stats() const
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    printf("GL debug: %zu errors, %zu performance warnings "
+           "(%zu stalls, %zu shader recompiles), %zu other\n",
+           m_errors, m_performance, m_stalls, m_recompiles, m_other);
+    if (m_untracked > 0) {
+        printf("  %zu messages not listed, over %zu distinct\n",
+               m_untracked, s_max_tracked_messages);
+    }
+    for (const auto& entry : m_messages) {
+        const message_stats& m = entry.second;
+        if (m.type == s_debug_type_error || m.type == s_debug_type_performance) {
+            printf("  %6zu x [%u] %s\n", m.count, entry.first, m.text.c_str());
+        }
+    }
+}
+
+void debug_output::reset_stats()
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    m_errors = 0;
+    m_performance = 0;
+    m_stalls = 0;
+    m_recompiles = 0;
+    m_other = 0;
+    m_untracked = 0;
+    m_messages.clear();
+}
+
+// Whether an error arrived since the last call; only in strict mode
+bool debug_output::take_error()
+{
+    if (!m_strict) {
+        return false;
+    }
+
+    if (!m_available) {
+        bool failed = false;
+        while (glGetError() != GL_NO_ERROR) {
+            failed = true;
+        }
+        return failed;
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    bool pending = m_error_pending;
+    m_error_pending = false;
+    return pending;
+}
+
+void APIENTRY debug_output::callback(GLenum source,
+                                     GLenum type,
+                                     GLuint id,
+                                     GLenum severity,
+                                     GLsizei length,
+                                     const GLchar *message,
+                                     const void *user)
+{
+    debug_output *self = static_cast<debug_output *>(const_cast<void *>(user));
+    string text = length < 0 ? string(message) : string(message, length);
+    self->handle(type, id, severity, text);
+}
+
+void debug_output::handle(GLenum type, GLuint id, GLenum severity, const string& text)
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    if (type == s_debug_type_error) {
+        m_errors++;
+        m_error_pending = true;
+    } else if (type == s_debug_type_performance) {
+        m_performance++;
+
+        string lower = text;
+        transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower.find("recompil") != string::npos) {
+            m_recompiles++;
+        } else if (lower.find("stall") != string::npos ||
+                   lower.find("synchroniz") != string::npos) {
+            m_stalls++;
+        }
+    } else {
+        m_other++;
+    }
+
+    auto it = m_messages.find(id);
+    if (it != m_messages.end()) {
+        it->second.count++;
+    } else if (m_messages.size() < s_max_tracked_messages) {
+        m_messages.emplace(id, message_stats{text, type, 1});
+    } else {
+        m_untracked++;
+    }
+
+    // Print each distinct message once, whether or not the summary has
+    // room for it
+    if (m_printed.insert(id).second && to_severity(severity) >= m_min_severity) {
+        fprintf(stderr, "GL debug (%s): %s\n", severity_name(severity), text.c_str());
+    }
+}
+
+void check_errors()
+{
+    if (gl_failed()) {
+        throw gl_error_ex;
+    }
+}
+
 string read_shader_source(const string& filename)
 {
     ifstream source_file;
@@ -348,6 +957,108 @@ string read_shader_source(const string& filename)
     return ss.str();
 }
 
+static const int s_max_include_depth = 16;
+
+static bool starts_with_directive(const string& line, const char *directive, size_t& end)
+{
+    size_t start = line.find_first_not_of(" \t");
+    if (start == string::npos || line.compare(start, strlen(directive), directive) != 0) {
+        return false;
+    }
+
+    end = start + strlen(directive);
+    return true;
+}
+
+static void expand_source(const string& filename,
+                          const vector<string>& defines,
+                          int depth,
+                          vector<string>& files,
+                          ostringstream& out)
+{
+    ifstream in(filename);
+    if (!in || depth > s_max_include_depth) {
+        throw include_ex;
+    }
+
+    int index = files.size();
+    files.push_back(filename);
+
+    size_t slash = filename.rfind('/');
+    string directory = slash == string::npos ? "" : filename.substr(0, slash + 1);
+
+    // Before the top file's #version only blank lines and comments may
+    // appear, so its defines wait until #version has been written
+    bool version_seen = depth > 0;
+    if (depth > 0) {
+        out << "#line 1 " << index << "\n";
+    }
+
+    string line;
+    int number = 0;
+    while (getline(in, line)) {
+        number++;
+
+        size_t end;
+        if (starts_with_directive(line, "#version", end)) {
+            if (depth == 0) {
+                out << line << "\n";
+                for (const string& define : defines) {
+                    out << "#define " << define << "\n";
+                }
+                out << "#line " << number + 1 << " " << index << "\n";
+            }
+            version_seen = true;
+            continue;
+        }
+
+        if (starts_with_directive(line, "#include", end)) {
+            size_t open = line.find('"', end);
+            size_t close = open == string::npos ? open : line.find('"', open + 1);
+            if (close == string::npos) {
+                throw include_ex;
+            }
+
+            string path = directory + line.substr(open + 1, close - open - 1);
+            if (find(files.begin(), files.end(), path) == files.end()) {
+                expand_source(path, defines, depth + 1, files, out);
+            }
+            out << "#line " << number + 1 << " " << index << "\n";
+            continue;
+        }
+
+        // No #version: the defines go before the first line of code
+        size_t code = line.find_first_not_of(" \t\r");
+        bool blank = code == string::npos || line.compare(code, 2, "//") == 0;
+        if (!version_seen && !blank) {
+            for (const string& define : defines) {
+                out << "#define " << define << "\n";
+            }
+            out << "#line " << number << " " << index << "\n";
+            version_seen = true;
+        }
+        out << line << "\n";
+    }
+}
+
+string preprocess_shader(const string& filename,
+                         const vector<string>& defines,
+                         vector<string>& files)
+{
+    // Include-once and the #line numbering are per call, whatever is
+    // already in files
+    vector<string> read;
+    ostringstream out;
+    expand_source(filename, defines, 0, read, out);
+    files.insert(files.end(), read.begin(), read.end());
+    return out.str();
+}
+
+uint64_t binds_and_uniforms()
+{
+    return s_binds_and_uniforms;
+}
+
 void clear_screen()
 {
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -4,8 +4,16 @@
 // Local Headers
 #include "glad/glad.h"
 
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
 // C++ Standard Headers
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace gl_wrapper {
 
@@ -25,6 +33,9 @@ class vao {
 
 /**
  *  RAII wrapper class for an OpenGL VBO
+ *
+ *  The usage hint of load() should be GL_STREAM_DRAW for data replaced
+ *  every frame.
  */
 class vbo {
  public:
@@ -32,7 +43,7 @@ class vbo {
     ~vbo();
 
     void bind();
-    void load(const GLvoid *data, GLsizeiptr size);
+    void load(const GLvoid *data, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW);
 
  private:
     GLuint m_handle;
@@ -53,6 +64,34 @@ class ebo {
     GLuint m_handle;
 };
 
+/**
+ *  RAII wrapper class for a buffer texture: a buffer object read by
+ *  shaders with texelFetch() through a samplerBuffer
+ *
+ *  load() keeps the existing store when the data fits in it and only
+ *  reallocates to grow, in whole pages, so a recycled buffer is reused
+ *  without going back to the driver.
+ */
+class buffer_texture {
+ public:
+    explicit buffer_texture(GLenum internal_format);
+    ~buffer_texture();
+
+    buffer_texture(const buffer_texture&) = delete;
+    buffer_texture& operator=(const buffer_texture&) = delete;
+
+    void bind();
+    void load(const GLvoid *data, GLsizeiptr size);
+
+    GLsizeiptr capacity() const;
+
+ private:
+    GLuint m_buffer;
+    GLuint m_texture;
+    GLenum m_internal_format;
+    GLsizeiptr m_capacity;
+};
+
 /**
  *  RAII wrapper class for an OpenGL shader object
  */
@@ -63,7 +102,9 @@ class shader {
     shader(GLenum shaderType);
     ~shader();
 
-    void compile(const std::string& filename);
+    void compile(const std::string& filename,
+                 const std::vector<std::string>& defines,
+                 std::vector<std::string>& files);
     bool compile_success();
     void print_compile_msg();
 
@@ -89,21 +130,53 @@ class program {
 
 /**
  *  Wrapper class for an OpenGL program and associated shaders
+ *
+ *  Both stages are run through preprocess_shader() with the same list of
+ *  defines, so one pair of source files can be built into specialized
+ *  variants (see shader_cache).  Uniform locations are looked up once
+ *  per name, and the last value set for each is kept so that reload()
+ *  can carry them over.  reload() rebuilds the program from its source
+ *  files and swaps it in only if everything compiles and links; on
+ *  failure it prints the error and the old program stays in use.
  */
 class shader_program {
  public:
     shader_program(const std::string& vertex_filename,
-                   const std::string& fragment_filename);
+                   const std::string& fragment_filename,
+                   const std::vector<std::string>& defines = {});
     void use();
     GLuint handle();
     void set_uniformi(const std::string& name, int value);
     void set_uniformf(const std::string& name, float value);
+    void set_uniform2f(const std::string& name, float x, float y);
+    void set_uniform3f(const std::string& name, float x, float y, float z);
     void set_uniform4fv(const std::string& name, const float *value);
 
+    bool reload();
+    const std::string& vertex_filename() const;
+    const std::string& fragment_filename() const;
+    const std::vector<std::string>& source_files() const;
+
  private:
+    struct uniform {
+        GLint location;
+        GLenum type;
+        GLint int_value;
+        float value[16];
+    };
+
+    uniform& find_uniform(const std::string& name, GLenum type);
+    static void apply(const uniform& u);
+
     program m_program;
     shader m_vertex_shader;
     shader m_fragment_shader;
+
+    std::string m_vertex_filename;
+    std::string m_fragment_filename;
+    std::vector<std::string> m_defines;
+    std::vector<std::string> m_files;
+    std::unordered_map<std::string, uniform> m_uniforms;
 };
 
 /**
@@ -142,11 +215,177 @@ class texture {
     image m_image;
 };
 
+/**
+ *  RAII wrapper class for a single channel OpenGL texture built from
+ *  memory, sampled without filtering (e.g. a bitmap font)
+ */
+class mask_texture {
+ public:
+    mask_texture(int width, int height, const uint8_t *pixels);
+    ~mask_texture();
+
+    mask_texture(const mask_texture&) = delete;
+    mask_texture& operator=(const mask_texture&) = delete;
+
+    void bind();
+
+ private:
+    GLuint m_handle;
+};
+
+/**
+ *  RAII wrapper class for a layered depth texture, with a framebuffer
+ *  for rendering into each layer (e.g. one shadow map per layer)
+ *
+ *  Shaders read it through a sampler2DArrayShadow, so lookups compare
+ *  against the stored depth and linear filtering blends the results of
+ *  the four nearest texels.  bind_layer() makes a layer the render target
+ *  and sets a viewport covering it; going back to the default
+ *  framebuffer and viewport is up to the caller.
+ */
+class depth_texture_array {
+ public:
+    depth_texture_array(int size, int layers);
+    ~depth_texture_array();
+
+    depth_texture_array(const depth_texture_array&) = delete;
+    depth_texture_array& operator=(const depth_texture_array&) = delete;
+
+    void bind();
+    void bind_layer(int layer);
+
+    int size() const;
+    int layers() const;
+
+ private:
+    GLuint m_texture;
+    std::vector<GLuint> m_framebuffers;
+    int m_size;
+};
+
+/**
+ *  Severity levels of driver debug messages, least severe first
+ */
+enum class debug_severity {
+    notification,
+    low,
+    medium,
+    high
+};
+
+/**
+ *  Routes driver messages from KHR_debug (core in GL 4.3) to the console
+ *  and keeps counts of them by type
+ *
+ *  Messages below the minimum severity are dropped by the driver, except
+ *  performance warnings, which are always counted so that slow paths the
+ *  driver falls back to (buffer stalls, shader recompiles) show up in
+ *  print_stats().  The entry points are not part of the GL 3.3 core
+ *  loader, so they are looked up through `load` (SDL_GL_GetProcAddress);
+ *  without them, or without a debug context, few or no messages arrive.
+ *
+ *  In strict mode output is synchronous, so a message arrives inside the
+ *  GL call that caused it, and any error makes the next gl_wrapper check
+ *  throw the exception for the operation in progress.  Exceptions are
+ *  never thrown from the callback itself, since it runs inside the
+ *  driver.  Only one debug_output may exist at a time.
+ */
+class debug_output {
+ public:
+    typedef void *(*load_proc)(const char *name);
+
+    debug_output(load_proc load, debug_severity min_severity, bool strict);
+    ~debug_output();
+
+    debug_output(const debug_output&) = delete;
+    debug_output& operator=(const debug_output&) = delete;
+
+    bool available() const;
+    void set_min_severity(debug_severity severity);
+
+    size_t error_count() const;
+    size_t performance_count() const;
+    size_t stall_count() const;
+    size_t recompile_count() const;
+
+    void print_stats() const;
+    void reset_stats();
+
+    bool take_error();
+
+ private:
+    struct message_stats {
+        std::string text;
+        GLenum type;
+        size_t count;
+    };
+
+    static void APIENTRY callback(GLenum source,
+                                  GLenum type,
+                                  GLuint id,
+                                  GLenum severity,
+                                  GLsizei length,
+                                  const GLchar *message,
+                                  const void *user);
+
+    void handle(GLenum type, GLuint id, GLenum severity, const std::string& text);
+
+    typedef void (APIENTRYP control_proc)(GLenum, GLenum, GLenum, GLsizei, const GLuint *, GLboolean);
+
+    control_proc m_control;
+    bool m_available;
+    bool m_strict;
+    debug_severity m_min_severity;
+
+    mutable std::mutex m_mutex;
+    size_t m_errors;
+    size_t m_performance;
+    size_t m_stalls;
+    size_t m_recompiles;
+    size_t m_other;
+    size_t m_untracked;
+    bool m_error_pending;
+    std::unordered_map<GLuint, message_stats> m_messages;
+
+    // Ids already printed; not cleared by reset_stats()
+    std::unordered_set<GLuint> m_printed;
+};
+
+/**
+ *  Throws if a strict debug_output has seen an error since the last
+ *  check; call at points where a failed frame should stop the program
+ */
+void check_errors();
+
+/**
+ *  Number of binds (programs, buffers, textures, VAOs, framebuffers) and
+ *  uniform updates made through gl_wrapper so far.  State set with raw GL
+ *  calls (enables, blend and depth state, texture units, viewports) is
+ *  not counted.  Only for the GL thread.
+ */
+uint64_t binds_and_uniforms();
+
 /**
  *  Convenience function: converts a text file to a std::string
  */
 std::string read_shader_source(const std::string& filename);
 
+/**
+ *  Reads a shader source file, expanding #include "name" directives and
+ *  inserting a #define for each entry of `defines` ("FOG" or
+ *  "FOG_DENSITY 0.02") right after the #version line
+ *
+ *  Included paths are relative to the including file and each file is
+ *  included at most once per call, so both stages of a program get a
+ *  shared include.  Every file read is appended to `files`, and #line
+ *  directives number them in the order this call read them, so "1(12)"
+ *  in a driver log is line 12 of the second file appended.  Throws if a
+ *  file cannot be read.
+ */
+std::string preprocess_shader(const std::string& filename,
+                              const std::vector<std::string>& defines,
+                              std::vector<std::string>& files);
+
 /**
  *  Convenience function for OpenGL calls to clear screen
  */
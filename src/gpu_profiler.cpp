@@ -0,0 +1,225 @@
+// Module Header
+#include "gpu_profiler.hpp"
+
+// C Standard Headers
+#include <cstdio>
+#include <cstring>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace gl_wrapper {
+
+// Cap on captured events, about 32MB; later scopes are not recorded
+static const size_t s_max_events = 1 << 20;
+
+// How often the GPU clock is re-matched against the CPU clock
+static const uint64_t s_calibrate_interval = 256;
+
+// Thread id the GPU track uses in trace files
+static const int s_gpu_trace_tid = 1000;
+
+static int64_t cpu_now_ns()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+gpu_profiler::gpu_profiler() :
+    m_frame_number(0),
+    m_frame_scope(-1),
+    m_depth(0),
+    m_dropped_frames(0),
+    m_capture(false),
+    m_gpu_to_cpu_ns(0)
+{
+    for (frame& f : m_frames) {
+        glGenQueries(2 * max_scopes, f.queries);
+        f.count = 0;
+        f.pending = false;
+    }
+
+    calibrate();
+}
+
+gpu_profiler::~gpu_profiler()
+{
+    for (frame& f : m_frames) {
+        glDeleteQueries(2 * max_scopes, f.queries);
+    }
+}
+
+void gpu_profiler::begin_frame()
+{
+    frame& f = m_frames[m_frame_number % frames_in_flight];
+    if (f.pending) {
+        resolve(f);
+    }
+
+    if (m_frame_number % s_calibrate_interval == 0) {
+        calibrate();
+    }
+
+    f.count = 0;
+    f.pending = false;
+    m_depth = 0;
+    m_frame_scope = begin_scope("frame");
+}
+
+void gpu_profiler::end_frame()
+{
+    end_scope(m_frame_scope);
+    m_frame_scope = -1;
+
+    frame& f = m_frames[m_frame_number % frames_in_flight];
+    f.pending = f.count > 0;
+    m_frame_number++;
+}
+
+int gpu_profiler::begin_scope(const char *name)
+{
+    frame& f = m_frames[m_frame_number % frames_in_flight];
+    if (f.count == max_scopes) {
+        return -1;
+    }
+
+    int scope = f.count++;
+    f.scopes[scope] = scope_record{name, m_depth++};
+    glQueryCounter(f.queries[2 * scope], GL_TIMESTAMP);
+    return scope;
+}
+
+void gpu_profiler::end_scope(int scope)
+{
+    if (scope < 0) {
+        return;
+    }
+
+    frame& f = m_frames[m_frame_number % frames_in_flight];
+    glQueryCounter(f.queries[2 * scope + 1], GL_TIMESTAMP);
+    m_depth--;
+}
+
+void gpu_profiler::print()
+{
+    printf("%-24s %10s %10s %10s\n", "GPU scope", "last ms", "avg ms", "max ms");
+    for (const scope_stats& s : m_stats) {
+        if (s.samples == 0) {
+            continue;
+        }
+
+        string label = string(2 * s.depth, ' ') + s.name;
+        printf("%-24s %10.3f %10.3f %10.3f\n",
+               label.c_str(), s.last_ms, s.total_ms / s.samples, s.max_ms);
+    }
+    if (m_dropped_frames > 0) {
+        printf("(%llu frames dropped waiting on queries)\n",
+               (unsigned long long)m_dropped_frames);
+    }
+}
+
+void gpu_profiler::reset_stats()
+{
+    for (scope_stats& s : m_stats) {
+        s.total_ms = 0;
+        s.max_ms = 0;
+        s.samples = 0;
+    }
+    m_dropped_frames = 0;
+}
+
+void gpu_profiler::set_capture(bool enabled)
+{
+    m_capture = enabled;
+}
+
+// Writes the GPU track as trace events, each preceded by a comma, to
+// follow other events in a Chrome trace's event array
+void gpu_profiler::write_trace_events(FILE *out) const
+{
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                 "\"args\":{\"name\":\"GPU\"}}", s_gpu_trace_tid);
+    for (const event& e : m_events) {
+        fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                     "\"ts\":%.3f,\"dur\":%.3f}",
+                e.name, s_gpu_trace_tid,
+                e.start_ns / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+    }
+}
+
+const vector<gpu_profiler::event>& gpu_profiler::events() const
+{
+    return m_events;
+}
+
+void gpu_profiler::resolve(frame& f)
+{
+    // The frame scope (scope 0) ends after every other scope, so once its
+    // end query is available all of them are
+    GLint available = 0;
+    glGetQueryObjectiv(f.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        m_dropped_frames++;
+        return;
+    }
+
+    for (int i = 0; i < f.count; i++) {
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(f.queries[2 * i], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(f.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+
+        const scope_record& r = f.scopes[i];
+        double ms = (double)(int64_t)(end - begin) / 1e6;
+
+        scope_stats& s = stats_for(r.name, r.depth);
+        s.last_ms = ms;
+        s.total_ms += ms;
+        s.max_ms = max(s.max_ms, ms);
+        s.samples++;
+
+        if (m_capture && m_events.size() < s_max_events) {
+            m_events.push_back(event{r.name,
+                                     r.depth,
+                                     (int64_t)begin + m_gpu_to_cpu_ns,
+                                     (int64_t)end + m_gpu_to_cpu_ns});
+        }
+    }
+}
+
+void gpu_profiler::calibrate()
+{
+    GLint64 gpu_ns = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_ns);
+    m_gpu_to_cpu_ns = cpu_now_ns() - gpu_ns;
+}
+
+gpu_profiler::scope_stats& gpu_profiler::stats_for(const char *name, int depth)
+{
+    for (scope_stats& s : m_stats) {
+        if (s.depth == depth && strcmp(s.name, name) == 0) {
+            return s;
+        }
+    }
+
+    m_stats.push_back(scope_stats{name, depth, 0, 0, 0, 0});
+    return m_stats.back();
+}
+
+gpu_scope::gpu_scope(gpu_profiler& profiler, const char *name) :
+    m_profiler(profiler),
+    m_scope(profiler.begin_scope(name))
+{
+}
+
+gpu_scope::~gpu_scope()
+{
+    m_profiler.end_scope(m_scope);
+}
+
+} // namespace gl_wrapper
@@ -0,0 +1,122 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+// Local Headers
+#include "glad/glad.h"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <vector>
+
+namespace gl_wrapper {
+
+/**
+ *  Measures GPU time spent in named scopes using timer queries
+ *
+ *  Each scope brackets its commands with GL_TIMESTAMP queries, so scopes
+ *  may nest (GL_TIME_ELAPSED queries cannot).  Queries are kept in a
+ *  ring of frames_in_flight frames and only read back once the ring
+ *  comes round again, by which time the GPU has normally finished them;
+ *  a frame whose results are still not ready is dropped rather than
+ *  waited on, so profiling never stalls the pipeline.
+ *
+ *  Resolved scopes feed per-name statistics for print(), and while
+ *  capture is on they are also kept as events on the CPU's steady clock,
+ *  which write_trace_events() appends to a Chrome trace as a GPU track
+ *  next to the CPU scopes from trace.hpp.  Scope names must be string
+ *  literals or otherwise outlive the profiler.
+ */
+class gpu_profiler {
+ public:
+    static const int frames_in_flight = 4;
+    static const int max_scopes = 64;
+
+    gpu_profiler();
+    ~gpu_profiler();
+
+    gpu_profiler(const gpu_profiler&) = delete;
+    gpu_profiler& operator=(const gpu_profiler&) = delete;
+
+    void begin_frame();
+    void end_frame();
+
+    int begin_scope(const char *name);
+    void end_scope(int scope);
+
+    void print();
+    void reset_stats();
+
+    void set_capture(bool enabled);
+    void write_trace_events(FILE *out) const;
+
+    struct event {
+        const char *name;
+        int depth;
+        int64_t start_ns;
+        int64_t end_ns;
+    };
+
+    const std::vector<event>& events() const;
+
+ private:
+    struct scope_record {
+        const char *name;
+        int depth;
+    };
+
+    struct frame {
+        GLuint queries[2 * max_scopes];
+        scope_record scopes[max_scopes];
+        int count;
+        bool pending;
+    };
+
+    struct scope_stats {
+        const char *name;
+        int depth;
+        double last_ms;
+        double total_ms;
+        double max_ms;
+        uint64_t samples;
+    };
+
+    void resolve(frame& f);
+    void calibrate();
+    scope_stats& stats_for(const char *name, int depth);
+
+    frame m_frames[frames_in_flight];
+    uint64_t m_frame_number;
+    int m_frame_scope;
+    int m_depth;
+
+    std::vector<scope_stats> m_stats;
+    uint64_t m_dropped_frames;
+
+    bool m_capture;
+    std::vector<event> m_events;
+    int64_t m_gpu_to_cpu_ns;
+};
+
+/**
+ *  Times the GPU commands issued during its lifetime as one named scope
+ */
+class gpu_scope {
+ public:
+    gpu_scope(gpu_profiler& profiler, const char *name);
+    ~gpu_scope();
+
+    gpu_scope(const gpu_scope&) = delete;
+    gpu_scope& operator=(const gpu_scope&) = delete;
+
+ private:
+    gpu_profiler& m_profiler;
+    int m_scope;
+};
+
+} // namespace gl_wrapper
+
+#endif // GPU_PROFILER_HPP
@@ -0,0 +1,29 @@
+// Module Header
+#include "input_state.hpp"
+
+// External Headers
+#include <SDL2/SDL.h>
+
+input_state::input_state() :
+    m_camera()
+{
+}
+
+void input_state::poll()
+{
+    const Uint8 *keys = SDL_GetKeyboardState(nullptr);
+
+    m_camera.forward = keys[SDL_SCANCODE_W];
+    m_camera.back = keys[SDL_SCANCODE_S];
+    m_camera.left = keys[SDL_SCANCODE_A];
+    m_camera.right = keys[SDL_SCANCODE_D];
+    m_camera.pitch_up = keys[SDL_SCANCODE_UP];
+    m_camera.pitch_down = keys[SDL_SCANCODE_DOWN];
+    m_camera.yaw_left = keys[SDL_SCANCODE_LEFT];
+    m_camera.yaw_right = keys[SDL_SCANCODE_RIGHT];
+}
+
+const camera_input& input_state::camera_controls() const
+{
+    return m_camera;
+}
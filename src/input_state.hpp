@@ -0,0 +1,26 @@
+#ifndef INPUT_STATE_HPP
+#define INPUT_STATE_HPP
+
+// Local Headers
+#include "camera.hpp"
+
+/**
+ *  Snapshot of which keys are held, taken once per frame
+ *
+ *  Movement reads the keyboard state rather than key events, so it does
+ *  not depend on the key repeat rate.  Call poll() after draining the
+ *  SDL event queue, since that is what updates SDL's keyboard state.
+ */
+class input_state {
+ public:
+    input_state();
+
+    void poll();
+
+    const camera_input& camera_controls() const;
+
+ private:
+    camera_input m_camera;
+};
+
+#endif // INPUT_STATE_HPP
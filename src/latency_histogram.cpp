@@ -0,0 +1,79 @@
+// Module Header
+#include "latency_histogram.hpp"
+
+// C Standard Headers
+#include <cstdio>
+#include <cstring>
+
+latency_histogram::latency_histogram()
+{
+    reset();
+}
+
+void latency_histogram::record(uint64_t micros)
+{
+    int bucket = 0;
+    while (bucket < bucket_count - 1 && (micros >> bucket) != 0) {
+        bucket++;
+    }
+
+    m_buckets[bucket]++;
+    m_count++;
+    m_total += micros;
+    if (micros > m_max) {
+        m_max = micros;
+    }
+}
+
+void latency_histogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_total = 0;
+    m_max = 0;
+}
+
+uint64_t latency_histogram::count() const
+{
+    return m_count;
+}
+
+uint64_t latency_histogram::max() const
+{
+    return m_max;
+}
+
+double latency_histogram::mean() const
+{
+    if (m_count == 0) {
+        return 0.0;
+    }
+
+    return (double)m_total / (double)m_count;
+}
+
+uint64_t latency_histogram::percentile(double p) const
+{
+    // Reports the upper bound of the bucket holding the p'th sample
+    uint64_t target = (uint64_t)(p * m_count);
+    uint64_t seen = 0;
+    for (int i = 0; i < bucket_count; i++) {
+        seen += m_buckets[i];
+        if (seen > target) {
+            return (uint64_t)1 << i;
+        }
+    }
+
+    return m_max;
+}
+
+void latency_histogram::print(const char *label) const
+{
+    printf("%s: %llu samples, mean %.1f us, p50 <%llu us, p99 <%llu us, max %llu us\n",
+           label,
+           (unsigned long long)m_count,
+           mean(),
+           (unsigned long long)percentile(0.50),
+           (unsigned long long)percentile(0.99),
+           (unsigned long long)m_max);
+}
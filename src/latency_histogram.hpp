@@ -0,0 +1,36 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+// C Standard Headers
+#include <cstdint>
+
+/**
+ *  Fixed-size log2 histogram of latencies in microseconds
+ *
+ *  Bucket i counts samples in [2^(i-1), 2^i) us, so recording is a
+ *  couple of instructions and never allocates.
+ */
+class latency_histogram {
+ public:
+    static const int bucket_count = 32;
+
+    latency_histogram();
+
+    void record(uint64_t micros);
+    void reset();
+
+    uint64_t count() const;
+    uint64_t max() const;
+    double mean() const;
+    uint64_t percentile(double p) const;
+
+    void print(const char *label) const;
+
+ private:
+    uint64_t m_buckets[bucket_count];
+    uint64_t m_count;
+    uint64_t m_total;
+    uint64_t m_max;
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
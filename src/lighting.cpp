@@ -0,0 +1,405 @@
+// Module Header
+#include "lighting.hpp"
+
+// Local Headers
+#include "trace.hpp"
+
+// C++ Standard Headers
+#include <vector>
+
+using namespace std;
+
+// Channel 0 is sky light, channel 1 block light
+static int get_level(const chunk& c, int ch, int index)
+{
+    return ch == 0 ? c.sky_light(index) : c.block_light(index);
+}
+
+static void set_level(chunk& c, int ch, int index, int level)
+{
+    if (ch == 0) {
+        c.set_sky_light(index, level);
+    } else {
+        c.set_block_light(index, level);
+    }
+}
+
+static void coords_of(int index, int local[3])
+{
+    local[0] = index % chunk::size;
+    local[2] = (index / chunk::size) % chunk::size;
+    local[1] = index / (chunk::size * chunk::size);
+}
+
+static uint64_t sections_of(int index)
+{
+    int local[3];
+    coords_of(index, local);
+    return world::border_sections(local[0], local[1], local[2]);
+}
+
+// Finds the neighbor of a cell across a face.  Returns false if it lies
+// in the adjacent chunk, in which case `neighbor` is its index there.
+static bool step(int index, int f, int& neighbor)
+{
+    int local[3];
+    coords_of(index, local);
+
+    bool inside = true;
+    for (int axis = 0; axis < 3; axis++) {
+        local[axis] += face_offsets[f][axis];
+        if (local[axis] < 0 || local[axis] >= chunk::size) {
+            local[axis] = floor_mod(local[axis], chunk::size);
+            inside = false;
+        }
+    }
+
+    neighbor = chunk::index(local[0], local[1], local[2]);
+    return inside;
+}
+
+static chunk_coord offset(const chunk_coord& coord, int f)
+{
+    return chunk_coord{coord.x + face_offsets[f][0],
+                       coord.y + face_offsets[f][1],
+                       coord.z + face_offsets[f][2]};
+}
+
+light_engine::light_engine(world& w) :
+    m_world(w)
+{
+    m_world.set_change_log(true);
+}
+
+void light_engine::update(worker_pool& pool)
+{
+    m_new_chunks.clear();
+    m_changes.clear();
+    m_world.take_new_chunks(m_new_chunks);
+    m_world.take_block_changes(m_changes);
+
+    if (m_new_chunks.empty() && m_changes.empty()) {
+        return;
+    }
+    TRACE_SCOPE("lighting");
+
+    // Edits inside a chunk that is flooded from scratch need no extra work
+    m_fresh.clear();
+    for (const chunk_coord& coord : m_new_chunks) {
+        if (m_fresh.insert(coord).second) {
+            seed_chunk(coord);
+        }
+    }
+    for (const block_change& change : m_changes) {
+        if (m_fresh.count(change.coord) == 0) {
+            seed_change(change);
+        }
+    }
+
+    // All removals finish before any refill, so light is never spread
+    // from a cell that is about to be retracted.
+    while (run_pass(pool, true)) {
+    }
+    while (run_pass(pool, false)) {
+    }
+
+    for (const auto& entry : m_queues) {
+        m_world.mark_sections_dirty(entry.first, entry.second.dirty_mask);
+    }
+    m_queues.clear();
+}
+
+void light_engine::seed_chunk(const chunk_coord& coord)
+{
+    chunk *c = m_world.find_chunk(coord);
+    if (c == nullptr) {
+        return;
+    }
+    queues& q = m_queues[coord];
+
+    if (!c->empty()) {
+        const block *blocks = c->data();
+        for (int i = 0; i < chunk::volume; i++) {
+            int emission = block_emission(blocks[i]);
+            if (emission > 0) {
+                c->set_block_light(i, emission);
+                q.add[block_channel].push_back(node{static_cast<uint16_t>(i), 0, 0});
+                q.dirty_mask |= sections_of(i);
+            }
+        }
+    }
+
+    if (m_world.find_chunk(offset(coord, static_cast<int>(face::pos_y))) == nullptr) {
+        for (int z = 0; z < chunk::size; z++) {
+            for (int x = 0; x < chunk::size; x++) {
+                int i = chunk::index(x, chunk::size - 1, z);
+                if (!block_opaque(c->data()[i])) {
+                    c->set_sky_light(i, max_light);
+                    q.add[sky_channel].push_back(node{static_cast<uint16_t>(i), 0, 0});
+                    q.dirty_mask |= sections_of(i);
+                }
+            }
+        }
+    }
+
+    // Light already in the neighbors flows in from their facing layers
+    for (int f = 0; f < face_count; f++) {
+        chunk_coord nc = offset(coord, f);
+        chunk *n = m_world.find_chunk(nc);
+        if (n == nullptr) {
+            continue;
+        }
+        queues& nq = m_queues[nc];
+
+        int axis = f / 2;
+        int layer = (f % 2 == 1) ? 0 : chunk::size - 1;
+        for (int v = 0; v < chunk::size; v++) {
+            for (int u = 0; u < chunk::size; u++) {
+                int local[3];
+                local[axis] = layer;
+                local[(axis + 1) % 3] = u;
+                local[(axis + 2) % 3] = v;
+                int i = chunk::index(local[0], local[1], local[2]);
+                uint16_t index = static_cast<uint16_t>(i);
+
+                // The chunk below was open to the sky until now
+                int sky = n->sky_light(i);
+                if (f == static_cast<int>(face::neg_y) && sky == max_light) {
+                    n->set_sky_light(i, 0);
+                    nq.remove[sky_channel].push_back(node{index, max_light, 0});
+                    nq.dirty_mask |= sections_of(i);
+                } else if (sky > 0) {
+                    nq.add[sky_channel].push_back(node{index, 0, 0});
+                }
+
+                if (n->block_light(i) > 0) {
+                    nq.add[block_channel].push_back(node{index, 0, 0});
+                }
+            }
+        }
+    }
+}
+
+void light_engine::seed_change(const block_change& change)
+{
+    chunk *c = m_world.find_chunk(change.coord);
+    if (c == nullptr) {
+        return;
+    }
+    queues& q = m_queues[change.coord];
+
+    int index = change.index;
+    block b = c->data()[index];
+
+    int local[3];
+    coords_of(index, local);
+    bool open_sky = local[1] == chunk::size - 1 &&
+                    m_world.find_chunk(offset(change.coord, static_cast<int>(face::pos_y))) == nullptr;
+
+    for (int ch = 0; ch < channel_count; ch++) {
+        int source = 0;
+        if (ch == block_channel) {
+            source = block_emission(b);
+        } else if (open_sky && !block_opaque(b)) {
+            source = max_light;
+        }
+
+        // Whatever the cell held depended on the old block
+        int level = get_level(*c, ch, index);
+        if (level > 0) {
+            q.remove[ch].push_back(node{change.index, static_cast<uint8_t>(level), 0});
+        }
+
+        set_level(*c, ch, index, source);
+        if (source > 0) {
+            q.add[ch].push_back(node{change.index, 0, 0});
+        }
+    }
+    q.dirty_mask |= sections_of(index);
+
+    if (!block_opaque(b)) {
+        seed_neighbors(change.coord, index);
+    }
+}
+
+void light_engine::seed_neighbors(const chunk_coord& coord, int index)
+{
+    for (int f = 0; f < face_count; f++) {
+        int neighbor;
+        chunk_coord nc = step(index, f, neighbor) ? coord : offset(coord, f);
+
+        chunk *n = m_world.find_chunk(nc);
+        if (n == nullptr) {
+            continue;
+        }
+
+        for (int ch = 0; ch < channel_count; ch++) {
+            if (get_level(*n, ch, neighbor) > 0) {
+                m_queues[nc].add[ch].push_back(node{static_cast<uint16_t>(neighbor), 0, 0});
+            }
+        }
+    }
+}
+
+bool light_engine::run_pass(worker_pool& pool, bool removing)
+{
+    m_jobs.clear();
+    for (auto& entry : m_queues) {
+        queues& q = entry.second;
+
+        bool work = false;
+        for (int ch = 0; ch < channel_count; ch++) {
+            work |= removing ? !q.remove[ch].empty() : !q.add[ch].empty();
+        }
+        if (!work) {
+            continue;
+        }
+
+        chunk *c = m_world.find_chunk(entry.first);
+        if (c == nullptr) {
+            for (int ch = 0; ch < channel_count; ch++) {
+                q.remove[ch].clear();
+                q.add[ch].clear();
+            }
+            continue;
+        }
+
+        m_jobs.push_back(job{entry.first, c, &q, {}});
+    }
+
+    if (m_jobs.empty()) {
+        return false;
+    }
+
+    pool.parallel_for(m_jobs.size(), [this, removing](size_t i) {
+        TRACE_SCOPE("light chunk");
+        if (removing) {
+            drain_removals(m_jobs[i]);
+        } else {
+            drain_additions(m_jobs[i]);
+        }
+    });
+
+    for (const job& j : m_jobs) {
+        for (const message& m : j.outbox) {
+            deliver(m);
+        }
+    }
+
+    return true;
+}
+
+void light_engine::deliver(const message& m)
+{
+    chunk *c = m_world.find_chunk(m.target);
+    if (c == nullptr) {
+        return;
+    }
+
+    queues& q = m_queues[m.target];
+    if (m.remove) {
+        visit_remove(*c, q, m.ch, m.n.index, m.n.level, m.n.down);
+    } else {
+        visit_add(*c, q, m.ch, m.n.index, m.n.level);
+    }
+}
+
+void light_engine::drain_removals(job& j)
+{
+    chunk& c = *j.target;
+    queues& q = *j.q;
+
+    for (int ch = 0; ch < channel_count; ch++) {
+        vector<node>& pending = q.remove[ch];
+        for (size_t i = 0; i < pending.size(); i++) {
+            node n = pending[i];
+
+            for (int f = 0; f < face_count; f++) {
+                bool down = f == static_cast<int>(face::neg_y);
+                int neighbor;
+                if (step(n.index, f, neighbor)) {
+                    visit_remove(c, q, ch, neighbor, n.level, down);
+                } else {
+                    node out{static_cast<uint16_t>(neighbor), n.level, down};
+                    j.outbox.push_back(message{offset(j.coord, f), static_cast<uint8_t>(ch), true, out});
+                }
+            }
+        }
+        pending.clear();
+    }
+}
+
+void light_engine::drain_additions(job& j)
+{
+    chunk& c = *j.target;
+    queues& q = *j.q;
+
+    for (int ch = 0; ch < channel_count; ch++) {
+        vector<node>& pending = q.add[ch];
+        for (size_t i = 0; i < pending.size(); i++) {
+            int index = pending[i].index;
+            int level = get_level(c, ch, index);
+            if (level == 0) {
+                continue;
+            }
+
+            for (int f = 0; f < face_count; f++) {
+                // Full strength sky light falls without fading
+                int spread = level - 1;
+                if (ch == sky_channel && level == max_light && f == static_cast<int>(face::neg_y)) {
+                    spread = max_light;
+                }
+                if (spread <= 0) {
+                    continue;
+                }
+
+                int neighbor;
+                if (step(index, f, neighbor)) {
+                    visit_add(c, q, ch, neighbor, spread);
+                } else {
+                    node out{static_cast<uint16_t>(neighbor), static_cast<uint8_t>(spread), 0};
+                    j.outbox.push_back(message{offset(j.coord, f), static_cast<uint8_t>(ch), false, out});
+                }
+            }
+        }
+        pending.clear();
+    }
+}
+
+void light_engine::visit_remove(chunk& c, queues& q, int ch, int index, int old, bool down)
+{
+    int level = get_level(c, ch, index);
+    if (level == 0) {
+        return;
+    }
+
+    // Emitters keep their own light and shine back into the gap
+    uint16_t i = static_cast<uint16_t>(index);
+    if (ch == block_channel && block_emission(c.data()[index]) > 0) {
+        q.add[ch].push_back(node{i, 0, 0});
+        return;
+    }
+
+    bool sky_column = ch == sky_channel && down && old == max_light && level == max_light;
+    if (level < old || sky_column) {
+        set_level(c, ch, index, 0);
+        q.remove[ch].push_back(node{i, static_cast<uint8_t>(level), 0});
+        q.dirty_mask |= sections_of(index);
+    } else {
+        // Lit from elsewhere; refill the retracted region from here
+        q.add[ch].push_back(node{i, 0, 0});
+    }
+}
+
+void light_engine::visit_add(chunk& c, queues& q, int ch, int index, int level)
+{
+    if (block_opaque(c.data()[index])) {
+        return;
+    }
+
+    if (get_level(c, ch, index) < level) {
+        set_level(c, ch, index, level);
+        q.add[ch].push_back(node{static_cast<uint16_t>(index), 0, 0});
+        q.dirty_mask |= sections_of(index);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef LIGHTING_HPP
+#define LIGHTING_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "world.hpp"
+#include "worker_pool.hpp"
+
+// C Standard Headers
+#include <cstdint>
+
+// C++ Standard Headers
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ *  Flood fill propagation of sky and block light through loaded chunks
+ *
+ *  Sky light enters through the top of every chunk with nothing loaded
+ *  above it and travels straight down at full strength; block light
+ *  starts at emissive blocks.  Both fade by one level per step
+ *  otherwise.  Changes are driven by the world's change log: new chunks
+ *  are flooded from scratch and block edits are handled incrementally,
+ *  first retracting the light that depended on the old block and then
+ *  refilling from the edges of the retracted region.
+ *
+ *  Each chunk's queues are drained by its own job on a worker_pool.
+ *  Light leaving a chunk is posted to the neighbor and picked up on the
+ *  next pass, so jobs never touch each other's chunks.
+ */
+class light_engine {
+ public:
+    explicit light_engine(world& w);
+
+    void update(worker_pool& pool);
+
+ private:
+    enum channel {
+        sky_channel = 0,
+        block_channel,
+        channel_count
+    };
+
+    struct node {
+        uint16_t index;
+        uint8_t level;
+        uint8_t down;
+    };
+
+    struct queues {
+        std::vector<node> remove[channel_count];
+        std::vector<node> add[channel_count];
+        uint64_t dirty_mask;
+    };
+
+    struct message {
+        chunk_coord target;
+        uint8_t ch;
+        bool remove;
+        node n;
+    };
+
+    struct job {
+        chunk_coord coord;
+        chunk *target;
+        queues *q;
+        std::vector<message> outbox;
+    };
+
+    void seed_chunk(const chunk_coord& coord);
+    void seed_change(const block_change& change);
+    void seed_neighbors(const chunk_coord& coord, int index);
+    bool run_pass(worker_pool& pool, bool removing);
+    void deliver(const message& m);
+
+    static void drain_removals(job& j);
+    static void drain_additions(job& j);
+    static void visit_remove(chunk& c, queues& q, int ch, int index, int old, bool down);
+    static void visit_add(chunk& c, queues& q, int ch, int index, int level);
+
+    world& m_world;
+    std::unordered_map<chunk_coord, queues, chunk_coord_hash> m_queues;
+
+    std::vector<chunk_coord> m_new_chunks;
+    std::unordered_set<chunk_coord, chunk_coord_hash> m_fresh;
+    std::vector<block_change> m_changes;
+    std::vector<job> m_jobs;
+};
+
+#endif // LIGHTING_HPP
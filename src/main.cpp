@@ -1,8 +1,25 @@
 // Local Headers
+#include "alloc_stats.hpp"
+#include "bench.hpp"
 #include "camera.hpp"
-#include "cube.hpp"
+#include "chunk_io.hpp"
+#include "chunk_pool.hpp"
+#include "chunk_renderer.hpp"
+#include "frame_arena.hpp"
+#include "frame_clock.hpp"
+#include "frame_pacer.hpp"
 #include "gl_wrapper.hpp"
+#include "gpu_profiler.hpp"
+#include "input_state.hpp"
+#include "lighting.hpp"
 #include "sdl_wrapper.hpp"
+#include "shader_watcher.hpp"
+#include "simulation.hpp"
+#include "stats_overlay.hpp"
+#include "trace.hpp"
+#include "worker_pool.hpp"
+#include "world.hpp"
+#include "world_store.hpp"
 
 // External Headers
 #include <glad/glad.h>
@@ -12,12 +29,15 @@
 #include <SDL2/SDL.h>
 
 // C Standard Headers
-#include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 // CPP Standard Headers
+#include <mutex>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -25,39 +45,224 @@ using namespace std;
 static int s_screen_width = 640;
 static int s_screen_height = 480;
 
+static const char *s_save_directory = "save";
+static const char *s_trace_filename = "trace.json";
+
+// Simulation rate, independent of the frame rate
+static const float s_tick_seconds = 1.0f / 60.0f;
+
+// Transient per-frame data; see the arena line in the stats overlay
+static const size_t s_frame_arena_bytes = 1 << 20;
+
+// Frame cap used when cycling into capped mode without --fps-cap
+static const float s_default_fps_cap = 144.0f;
+
+// --bench-shadows: frames left to settle once the world has loaded, then
+// frames timed for each way of updating the cascades
+static const uint32_t s_bench_warmup_frames = 60;
+static const uint32_t s_bench_frames = 300;
+
+// A frame cap paces frames itself, with the swap interval left at zero
+static void apply_pacing(sdl_wrapper::wrapper& sdk,
+                         frame_pacer& pacer,
+                         sdl_wrapper::swap_mode mode,
+                         float fps_cap)
+{
+    if (fps_cap > 0) {
+        mode = sdl_wrapper::swap_mode::uncapped;
+    }
+    sdk.set_swap_mode(mode);
+    pacer.set_rate(fps_cap);
+
+    if (fps_cap > 0) {
+        printf("Frame pacing: capped at %.0f fps\n", fps_cap);
+    } else {
+        printf("Frame pacing: %s\n", sdl_wrapper::swap_mode_name(sdk.current_swap_mode()));
+    }
+}
+
+// Steps through vsync, adaptive vsync, uncapped and a frame cap
+static void cycle_pacing(sdl_wrapper::wrapper& sdk, frame_pacer& pacer, float fps_cap)
+{
+    using sdl_wrapper::swap_mode;
+
+    if (pacer.rate() > 0) {
+        apply_pacing(sdk, pacer, swap_mode::vsync, 0);
+    } else if (sdk.current_swap_mode() == swap_mode::vsync) {
+        apply_pacing(sdk, pacer, swap_mode::adaptive, 0);
+    } else if (sdk.current_swap_mode() == swap_mode::adaptive) {
+        apply_pacing(sdk, pacer, swap_mode::uncapped, 0);
+    } else {
+        apply_pacing(sdk, pacer, swap_mode::uncapped, fps_cap);
+    }
+}
+
+static void toggle_feature(chunk_renderer& renderer, terrain_feature feature, const char *name)
+{
+    uint32_t features = renderer.features() ^ feature;
+    try {
+        renderer.set_features(features);
+    } catch (const exception& e) {
+        fprintf(stderr, "Terrain shader variant failed to build: %s\n", e.what());
+        return;
+    }
+    printf("Terrain %s %s\n", name, (features & feature) ? "on" : "off");
+}
+
+static void toggle_depth_prepass(chunk_renderer& renderer)
+{
+    renderer.set_depth_prepass(!renderer.depth_prepass());
+    printf("Depth pre-pass %s\n", renderer.depth_prepass() ? "on" : "off");
+}
+
+static void toggle_overdraw(chunk_renderer& renderer)
+{
+    try {
+        renderer.set_overdraw(!renderer.overdraw());
+    } catch (const exception& e) {
+        fprintf(stderr, "Overdraw shader variant failed to build: %s\n", e.what());
+        return;
+    }
+    printf("Overdraw view %s\n", renderer.overdraw() ? "on" : "off");
+}
+
+static void generate_world(world& w)
+{
+    TRACE_SCOPE("generate world");
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 20; j++) {
+            for (int k = 0; k < 20; k++) {
+                w.set_block(i, j, k, block::crate);
+            }
+        }
+    }
+
+    // A pool sunk into the top and a glass wall standing on it, to
+    // exercise the translucent pass
+    for (int i = 30; i < 50; i++) {
+        for (int j = 17; j < 20; j++) {
+            for (int k = 4; k < 16; k++) {
+                w.set_block(i, j, k, block::water);
+            }
+        }
+    }
+    for (int j = 20; j < 26; j++) {
+        for (int k = 0; k < 20; k++) {
+            w.set_block(70, j, k, block::glass);
+        }
+    }
+}
+
 int main(int argc, char** argv)
 {
-    sdl_wrapper::wrapper sdk(s_screen_width, s_screen_height);
+    bool sim_thread = false;
+    bool trace = false;
+    bool gl_debug = false;
+    bool bench_shadows = false;
+    sdl_wrapper::swap_mode swap = sdl_wrapper::swap_mode::vsync;
+    float fps_cap = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            return run_benchmarks();
+        } else if (strcmp(argv[i], "--bench-shadows") == 0) {
+            bench_shadows = true;
+            swap = sdl_wrapper::swap_mode::uncapped;
+        } else if (strcmp(argv[i], "--sim-thread") == 0) {
+            sim_thread = true;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+            trace::set_enabled(true);
+        } else if (strcmp(argv[i], "--gl-debug") == 0) {
+            gl_debug = true;
+        } else if (strcmp(argv[i], "--vsync") == 0) {
+            swap = sdl_wrapper::swap_mode::vsync;
+        } else if (strcmp(argv[i], "--adaptive-vsync") == 0) {
+            swap = sdl_wrapper::swap_mode::adaptive;
+        } else if (strcmp(argv[i], "--uncapped") == 0) {
+            swap = sdl_wrapper::swap_mode::uncapped;
+        } else if (strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc) {
+            fps_cap = strtof(argv[++i], nullptr);
+        }
+    }
+
+    TRACE_THREAD_NAME("main");
+
+    sdl_wrapper::wrapper sdk(s_screen_width, s_screen_height,
+                             sdl_wrapper::swap_mode::vsync, gl_debug);
     SDL_Window* window = sdk.window();
 
+    // --gl-debug reports everything and turns GL errors into exceptions;
+    // otherwise only serious messages and performance warnings are kept.
+    gl_wrapper::debug_output gl_messages(SDL_GL_GetProcAddress,
+                                         gl_debug ? gl_wrapper::debug_severity::low
+                                                  : gl_wrapper::debug_severity::medium,
+                                         gl_debug);
+
+    frame_pacer pacer;
+    apply_pacing(sdk, pacer, swap, fps_cap);
+    if (fps_cap <= 0) {
+        fps_cap = s_default_fps_cap;
+    }
+
     glm::mat4 proj = glm::perspective(glm::radians(45.0f),
                                       (float)s_screen_width / (float)s_screen_height,
                                       0.1f, 100.0f);
 
-    cube voxel_cube;
+    chunk_renderer renderer;
     camera cam;
 
-    voxel_cube.set_projection(proj);
+    gl_wrapper::gpu_profiler gpu;
+    gpu.set_capture(trace);
+
+    renderer.set_projection(proj);
+
+    stats_overlay overlay;
+    overlay.set_screen_size(s_screen_width, s_screen_height);
+
+    // Saving a shader source swaps in the rebuilt program
+    shader_watcher shaders;
+    renderer.watch_shaders(shaders);
+    shaders.watch(overlay.program());
+
+    world voxel_world;
+    light_engine lighting(voxel_world);
+    worker_pool workers;
+    world_store store(s_save_directory);
+    chunk_io io(store);
+
+    // Saved chunks stream in from the I/O threads while we render
+    vector<chunk_coord> saved;
+    store.saved_chunks(saved);
+    if (saved.empty()) {
+        generate_world(voxel_world);
+    }
+    for (const chunk_coord& coord : saved) {
+        io.request_load(coord);
+    }
+
+    simulation sim(voxel_world, lighting, io, workers, cam, s_tick_seconds);
+    if (sim_thread) {
+        sim.start_thread();
+    }
+
+    input_state input;
+    frame_clock clock;
+    frame_arena arena(s_frame_arena_bytes);
 
     uint32_t frames = 0;
     float total_time = 0;
-    bool quit = false;
-    uint32_t last_frame = SDL_GetTicks();
 
-    glm::mat4 model_vectors[100][20][20];
-    for (int i = 0; i < 100; i++) {
-        for (int j = 0; j < 20; j++) {
-            for (int k = 0; k < 20; k++) {
-                glm::mat4 model(1.0f);
-                model_vectors[i][j][k] = glm::translate(model, glm::vec3((float)i, (float)j, (float)k));
-            }
-        }
-    }
+    // Steady state frames should make no heap allocations at all
+    uint64_t frame_allocations = 0;
+    uint64_t window_allocations = 0;
+    uint32_t allocating_frames = 0;
+    uint32_t bench_frame = 0;
+    bool quit = false;
 
     while (!quit) {
-        uint32_t current_frame = SDL_GetTicks();
-        float delta = current_frame - last_frame;
-        last_frame = current_frame;
+        TRACE_SCOPE("frame");
+        float delta = clock.tick();
+        uint64_t allocations_before = alloc_stats::thread_allocations();
 
         SDL_Event e;
         while (SDL_PollEvent(&e) != 0) {
@@ -69,30 +274,114 @@ int main(int argc, char** argv)
                 case SDL_WINDOWEVENT:
                     if (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
                         glViewport(0, 0, e.window.data1, e.window.data2);
+                        overlay.set_screen_size(e.window.data1, e.window.data2);
                     }
                     break;
 
+                case SDL_MOUSEBUTTONDOWN:
+                    sim.pick(e.button.button);
+                    break;
+
                 case SDL_KEYDOWN:
                     switch (e.key.keysym.sym) {
-                        case SDLK_w:        cam.move_forward(delta); break;
-                        case SDLK_s:        cam.move_back(delta);    break;
-                        case SDLK_a:        cam.move_left(delta);    break;
-                        case SDLK_d:        cam.move_right(delta);   break;
-                        case SDLK_UP:       cam.pitch_up(delta);     break;
-                        case SDLK_DOWN:     cam.pitch_down(delta);   break;
-                        case SDLK_LEFT:     cam.yaw_left(delta);     break;
-                        case SDLK_RIGHT:    cam.yaw_right(delta);    break;
-                        default: /* No action */                     break;
+                        case SDLK_e:        sim.blast();  break;
+                        case SDLK_v:        cycle_pacing(sdk, pacer, fps_cap); break;
+                        case SDLK_F3:       overlay.toggle(); break;
+                        case SDLK_F4:       toggle_feature(renderer, terrain_ao, "ambient occlusion"); break;
+                        case SDLK_F5:       toggle_feature(renderer, terrain_fog, "fog"); break;
+                        case SDLK_F6:       toggle_depth_prepass(renderer); break;
+                        case SDLK_F7:       toggle_overdraw(renderer); break;
+                        case SDLK_F8:       toggle_feature(renderer, terrain_shadows, "shadows"); break;
+                        default: /* No action */          break;
                     }
             }
         }
 
-        gl_wrapper::clear_screen();
+        shaders.poll();
+        input.poll();
+        sim.set_input(input.camera_controls());
+        if (!sim_thread) {
+            TRACE_SCOPE("simulate");
+            sim.advance(delta);
+        }
+
+        size_t chunks_loaded;
+        {
+            TRACE_SCOPE("sync world");
+            lock_guard<mutex> lock(sim.world_mutex());
+            renderer.update(voxel_world);
+            chunks_loaded = voxel_world.chunk_count();
+        }
+
+        gpu.begin_frame();
+        {
+            gl_wrapper::gpu_scope scope(gpu, "shadows");
+            renderer.draw_shadows(sim.view(), gpu);
+        }
+        {
+            gl_wrapper::gpu_scope scope(gpu, "clear");
+            gl_wrapper::clear_screen();
+        }
+        {
+            gl_wrapper::gpu_scope scope(gpu, "terrain");
+            renderer.draw(sim.view(), arena);
+        }
+        overlay.record_frame(delta);
+        if (overlay.visible()) {
+            gl_wrapper::gpu_scope scope(gpu, "overlay");
+            const render_stats& stats = renderer.stats();
+            float frame_time = overlay.average_frame();
+
+            overlay.print("%.2f ms  %.0f fps", frame_time * 1000.0f,
+                          frame_time > 0 ? 1.0f / frame_time : 0.0f);
+            overlay.print("draws %zu  tris %zu  binds/uniforms %zu",
+                          stats.draw_calls, stats.triangles, stats.binds_and_uniforms);
+            overlay.print("chunks %zu  sections %zu/%zu",
+                          chunks_loaded, stats.sections_drawn, renderer.section_count());
+            overlay.print("translucent %zu  resorted %zu",
+                          stats.translucent_drawn, stats.sections_resorted);
+            overlay.print("shadow passes %zu  sections %zu",
+                          stats.shadow_passes, stats.shadow_sections);
+            overlay.print("remeshed %zu  mesh mem %.1f/%.1f MB  peak %.1f",
+                          stats.sections_remeshed,
+                          stats.buffer_bytes / (1024.0f * 1024.0f),
+                          stats.buffer_capacity / (1024.0f * 1024.0f),
+                          stats.buffer_high_water / (1024.0f * 1024.0f));
+            chunk_pool::stats pool = chunk_pool::shared().get_stats();
+            overlay.print("chunk pool %zu/%zu  peak %zu  %.1f MB",
+                          pool.live, pool.capacity, pool.high_water,
+                          pool.reserved_bytes / (1024.0f * 1024.0f));
+            overlay.print("io queue %zu  workers %d",
+                          io.queue_depth(), workers.thread_count());
+            overlay.print("allocs %llu  arena %zu/%zu KB",
+                          (unsigned long long)frame_allocations,
+                          arena.high_water() / 1024, arena.capacity() / 1024);
+            overlay.draw();
+        }
+        gpu.end_frame();
+        if (gl_debug) {
+            gl_wrapper::check_errors();
+        }
+
+        // Once loading is done and the frames have settled, time a run of
+        // frames with the far cascades amortized, then one with every
+        // cascade redrawn every frame, and quit
+        if (bench_shadows) {
+            bench_frame = io.queue_depth() > 0 ? 0 : bench_frame + 1;
+            if (bench_frame <= s_bench_warmup_frames) {
+                gpu.reset_stats();
+            } else if (bench_frame == s_bench_warmup_frames + s_bench_frames) {
+                printf("Shadow passes over %u frames, %s:\n", s_bench_frames,
+                       renderer.shadow_amortize() ? "far cascades amortized"
+                                                  : "every cascade every frame");
+                gpu.print();
+                printf("\n");
 
-        for (int i = 0; i < 100; i++) {
-            for (int j = 0; j < 20; j++) {
-                for (int k = 0; k < 20; k++) {
-                    voxel_cube.draw(model_vectors[i][j][k], cam.view());
+                if (renderer.shadow_amortize()) {
+                    renderer.set_shadow_amortize(false);
+                    bench_frame = 0;
+                } else {
+                    quit = true;
                 }
             }
         }
@@ -101,14 +390,63 @@ int main(int argc, char** argv)
         frames++;
         total_time += delta;
         if (frames >= 100) {
-            float frame_time = (float)total_time / (float)frames;
-            printf("100 frames in %.2f ms.\n", total_time);
-            printf("%.2f fps\n\n", 1000.0f / frame_time);
+            float frame_time = total_time / (float)frames;
+            printf("100 frames in %.2f ms.\n", total_time * 1000.0f);
+            printf("%.2f fps\n", 1.0f / frame_time);
+            printf("%zu chunk I/O requests queued\n", io.queue_depth());
+            if (alloc_stats::enabled()) {
+                printf("%llu heap allocations in %u of 100 frames\n",
+                       (unsigned long long)window_allocations, allocating_frames);
+            }
+            if (!bench_shadows) {
+                gpu.print();
+                gpu.reset_stats();
+            }
+            if (gl_messages.performance_count() > 0) {
+                printf("%zu GL performance warnings (%zu stalls, %zu recompiles)\n",
+                       gl_messages.performance_count(),
+                       gl_messages.stall_count(),
+                       gl_messages.recompile_count());
+            }
+            printf("\n");
             frames = 0;
             total_time = 0;
+            window_allocations = 0;
+            allocating_frames = 0;
+        }
+
+        {
+            TRACE_SCOPE("present");
+            pacer.wait();
+            SDL_GL_SwapWindow(window);
+        }
+
+        arena.reset();
+        frame_allocations = alloc_stats::thread_allocations() - allocations_before;
+        window_allocations += frame_allocations;
+        if (frame_allocations > 0) {
+            allocating_frames++;
         }
+    }
+
+    sim.stop_thread();
+
+    io.save_world(voxel_world);
+    io.flush();
+
+    vector<chunk_io::loaded_chunk> loaded;
+    vector<chunk_coord> failed_saves;
+    io.poll(loaded, failed_saves);
+    if (!failed_saves.empty()) {
+        fprintf(stderr, "%zu chunks could not be saved\n", failed_saves.size());
+    }
+    io.print_stats();
+    chunk_pool::shared().print_stats();
+    gl_messages.print_stats();
 
-        SDL_GL_SwapWindow(window);
+    auto gpu_track = [&gpu](FILE *out) { gpu.write_trace_events(out); };
+    if (trace && !trace::write_chrome_trace(s_trace_filename, gpu_track)) {
+        fprintf(stderr, "Failed to write %s\n", s_trace_filename);
     }
 
     return 0;
@@ -0,0 +1,400 @@
+// Module Header
+#include "mesher.hpp"
+
+// Local Headers
+#include "cube.hpp"
+#include "trace.hpp"
+
+// External Headers
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// C Standard Headers
+#include <cstring>
+
+// C++ Standard Headers
+#include <vector>
+
+using namespace std;
+
+static_assert(mesher::extent <= 16, "face records hold 4 bit coordinates");
+static_assert(max_light <= 15, "face records hold 4 bit light levels");
+static_assert(mesher::extent % 8 == 0, "face culling works on rows of eight");
+
+// Padded bits 1..extent, once shifted down to section coordinates
+static const uint32_t s_interior = (1u << mesher::extent) - 1;
+
+// Occupancy layer of each block: opaque blocks share layer 0, then one
+// per translucent block; air is in none.  A face is hidden by an opaque
+// neighbor or one of the same block, so water shows no faces inside a
+// pool but does against glass.  Translucent faces go to their own list.
+static int layer_of(block b)
+{
+    switch (b) {
+        case block::air:
+            return -1;
+        case block::water:
+            return 1;
+        case block::glass:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+mesher::mesher(culling mode) :
+    m_culling(mode)
+{
+}
+
+void mesher::mesh(const world& w,
+                  const section_coord& coord,
+                  vector<uint32_t>& faces,
+                  vector<uint32_t>& translucent_faces)
+{
+    TRACE_SCOPE("mesh section");
+    faces.clear();
+    translucent_faces.clear();
+
+    if (!gather(w, coord)) {
+        return;
+    }
+
+    if (m_culling == culling::naive) {
+        find_faces_naive();
+    } else {
+        find_faces(0, m_exposed, false);
+        if (m_has_translucent) {
+            for (int layer = 1; layer < layer_count; layer++) {
+                find_faces(layer, m_translucent_exposed, layer > 1);
+            }
+        }
+    }
+
+    emit_faces(m_exposed, faces);
+    if (m_has_translucent) {
+        emit_faces(m_translucent_exposed, translucent_faces);
+    }
+}
+
+void mesher::face_center(uint32_t shape, float center[3])
+{
+    const int *n = face_offsets[(shape >> 12) & 7];
+    for (int axis = 0; axis < 3; axis++) {
+        center[axis] = ((shape >> (4 * axis)) & 15) + 0.5f + 0.5f * n[axis];
+    }
+}
+
+bool mesher::gather(const world& w, const section_coord& coord)
+{
+    chunk_coord home = world::chunk_of_section(coord);
+    const chunk *center = w.find_chunk(home);
+    if (center == nullptr || center->empty()) {
+        return false;
+    }
+
+    // Neighborhood of chunk pointers; a padded section can only reach one
+    // chunk past its own on each axis.
+    const chunk *neighbors[3][3][3];
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                chunk_coord c{home.x + dx, home.y + dy, home.z + dz};
+                neighbors[dy + 1][dz + 1][dx + 1] = w.find_chunk(c);
+            }
+        }
+    }
+
+    // Per-axis mapping from padded index to (neighbor slot, local coord)
+    int origin[3] = {coord.x * extent, coord.y * extent, coord.z * extent};
+    int slot[3][padded];
+    int local[3][padded];
+    for (int axis = 0; axis < 3; axis++) {
+        int home_axis = (&home.x)[axis];
+        for (int i = 0; i < padded; i++) {
+            int block_coord = origin[axis] + i - 1;
+            slot[axis][i] = floor_div(block_coord, chunk::size) - home_axis + 1;
+            local[axis][i] = floor_mod(block_coord, chunk::size);
+        }
+    }
+
+    // Unloaded space reads as air under the open sky
+    static const uint8_t open_sky = max_light << 4;
+
+    block *out = m_blocks;
+    uint8_t *light = m_light;
+    uint32_t translucent = 0;
+    for (int y = 0; y < padded; y++) {
+        for (int z = 0; z < padded; z++) {
+            uint32_t row[layer_count] = {};
+            for (int x = 0; x < padded; x++) {
+                const chunk *c = neighbors[slot[1][y]][slot[2][z]][slot[0][x]];
+                if (c == nullptr) {
+                    *out++ = block::air;
+                    *light++ = open_sky;
+                } else {
+                    int i = chunk::index(local[0][x], local[1][y], local[2][z]);
+                    block b = c->data()[i];
+                    *out++ = b;
+                    *light++ = c->light_data()[i];
+
+                    int layer = layer_of(b);
+                    if (layer >= 0) {
+                        row[layer] |= 1u << x;
+                    }
+                }
+            }
+
+            for (int layer = 0; layer < layer_count; layer++) {
+                m_rows[layer][y][z] = row[layer];
+            }
+            bool inside = y >= 1 && y <= extent && z >= 1 && z <= extent;
+            for (int layer = 1; inside && layer < layer_count; layer++) {
+                translucent |= row[layer] & (s_interior << 1);
+            }
+        }
+    }
+
+    // Translucent blocks only in the border make no faces of this section,
+    // so only the section's own cells count
+    m_has_translucent = translucent != 0;
+    return true;
+}
+
+// Exposed faces on bitmasks: gather() packs each x row of the padded
+// array into an occupancy word, and a face is exposed where its row is
+// solid and the neighbor row (or bit) is not, so one AND-NOT finds a
+// whole row of faces.  Rows go eight or four at a time with AVX2 or SSE2.
+//
+// For each section row, the neighbors across the six faces in face order
+// are: the row shifted one bit either way (x), the rows below and above
+// (y) and the rows before and after (z).  Padded row z + 1 is section z.
+// A face is hidden by an opaque neighbor or one from its own layer, so
+// each neighbor row is the OR of both; for layer 0 they are the same.
+void mesher::find_faces(int layer, face_masks& exposed, bool accumulate)
+{
+    const uint32_t (*rows)[padded] = m_rows[layer];
+    const uint32_t (*opaque_rows)[padded] = m_rows[0];
+
+    for (int y = 0; y < extent; y++) {
+#if defined(__AVX2__)
+        const __m256i interior = _mm256_set1_epi32(s_interior);
+        auto blockers = [&](int row_y, int row_z) {
+            return _mm256_or_si256(_mm256_loadu_si256((const __m256i *)&rows[row_y][row_z]),
+                                   _mm256_loadu_si256((const __m256i *)&opaque_rows[row_y][row_z]));
+        };
+        for (int z = 0; z < extent; z += 8) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)&rows[y + 1][z + 1]);
+            __m256i hide = blockers(y + 1, z + 1);
+            __m256i n[face_count] = {
+                _mm256_slli_epi32(hide, 1),
+                _mm256_srli_epi32(hide, 1),
+                blockers(y, z + 1),
+                blockers(y + 2, z + 1),
+                blockers(y + 1, z),
+                blockers(y + 1, z + 2)
+            };
+            for (int f = 0; f < face_count; f++) {
+                __m256i *out = (__m256i *)&exposed[f][y][z];
+                __m256i e = _mm256_srli_epi32(_mm256_andnot_si256(n[f], c), 1);
+                e = _mm256_and_si256(e, interior);
+                if (accumulate) {
+                    e = _mm256_or_si256(e, _mm256_loadu_si256(out));
+                }
+                _mm256_storeu_si256(out, e);
+            }
+        }
+#elif defined(__SSE2__)
+        const __m128i interior = _mm_set1_epi32(s_interior);
+        auto blockers = [&](int row_y, int row_z) {
+            return _mm_or_si128(_mm_loadu_si128((const __m128i *)&rows[row_y][row_z]),
+                                _mm_loadu_si128((const __m128i *)&opaque_rows[row_y][row_z]));
+        };
+        for (int z = 0; z < extent; z += 4) {
+            __m128i c = _mm_loadu_si128((const __m128i *)&rows[y + 1][z + 1]);
+            __m128i hide = blockers(y + 1, z + 1);
+            __m128i n[face_count] = {
+                _mm_slli_epi32(hide, 1),
+                _mm_srli_epi32(hide, 1),
+                blockers(y, z + 1),
+                blockers(y + 2, z + 1),
+                blockers(y + 1, z),
+                blockers(y + 1, z + 2)
+            };
+            for (int f = 0; f < face_count; f++) {
+                __m128i *out = (__m128i *)&exposed[f][y][z];
+                __m128i e = _mm_srli_epi32(_mm_andnot_si128(n[f], c), 1);
+                e = _mm_and_si128(e, interior);
+                if (accumulate) {
+                    e = _mm_or_si128(e, _mm_loadu_si128(out));
+                }
+                _mm_storeu_si128(out, e);
+            }
+        }
+#else
+        auto blockers = [&](int row_y, int row_z) {
+            return rows[row_y][row_z] | opaque_rows[row_y][row_z];
+        };
+        for (int z = 0; z < extent; z++) {
+            uint32_t c = rows[y + 1][z + 1];
+            uint32_t hide = blockers(y + 1, z + 1);
+            uint32_t n[face_count] = {
+                hide << 1,
+                hide >> 1,
+                blockers(y, z + 1),
+                blockers(y + 2, z + 1),
+                blockers(y + 1, z),
+                blockers(y + 1, z + 2)
+            };
+            for (int f = 0; f < face_count; f++) {
+                uint32_t e = ((c & ~n[f]) >> 1) & s_interior;
+                exposed[f][y][z] = accumulate ? exposed[f][y][z] | e : e;
+            }
+        }
+#endif
+    }
+}
+
+// Per-voxel neighbor check, kept for benchmarking and for checking the
+// bitmask kernel against
+void mesher::find_faces_naive()
+{
+    memset(m_exposed, 0, sizeof(m_exposed));
+    memset(m_translucent_exposed, 0, sizeof(m_translucent_exposed));
+
+    for (int y = 0; y < extent; y++) {
+        for (int z = 0; z < extent; z++) {
+            for (int x = 0; x < extent; x++) {
+                block b = at(x, y, z);
+                if (b == block::air) {
+                    continue;
+                }
+
+                face_masks& exposed = block_translucent(b) ? m_translucent_exposed : m_exposed;
+                for (int f = 0; f < face_count; f++) {
+                    const int *n = face_offsets[f];
+                    block neighbor = at(x + n[0], y + n[1], z + n[2]);
+                    if (!block_opaque(neighbor) && neighbor != b) {
+                        exposed[f][y][z] |= 1u << x;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void mesher::emit_faces(const face_masks& exposed, vector<uint32_t>& faces)
+{
+    for (int y = 0; y < extent; y++) {
+        for (int z = 0; z < extent; z++) {
+            uint32_t any = 0;
+            for (int f = 0; f < face_count; f++) {
+                any |= exposed[f][y][z];
+            }
+
+            // Blocks with at least one face showing, in x order
+            for (; any != 0; any &= any - 1) {
+                int x = __builtin_ctz(any);
+
+                for (int f = 0; f < face_count; f++) {
+                    if ((exposed[f][y][z] & (1u << x)) == 0) {
+                        continue;
+                    }
+
+                    corner_shade shade[cube::face_corner_count];
+                    shade_face(x, y, z, static_cast<face>(f), shade);
+
+                    // The shared quad indices split between the first and
+                    // third corner, so flipping starts from corner 1
+                    int diagonal_02 = shade[0].ao + shade[2].ao;
+                    int diagonal_13 = shade[1].ao + shade[3].ao;
+                    uint32_t flip = diagonal_13 > diagonal_02 ? 1 : 0;
+
+                    uint32_t shape = x | y << 4 | z << 8 | f << 12 | flip << 15;
+                    uint32_t light = 0;
+                    for (int corner = 0; corner < cube::face_corner_count; corner++) {
+                        shape |= shade[corner].ao << (16 + 2 * corner);
+                        light |= (shade[corner].sky | shade[corner].glow << 4) << (8 * corner);
+                    }
+                    shape |= static_cast<uint32_t>(at(x, y, z)) << 24;
+
+                    faces.push_back(shape);
+                    faces.push_back(light);
+                }
+            }
+        }
+    }
+}
+
+// Ambient occlusion per corner from the three voxels touching it in front
+// of the face (0 = fully occluded, 3 = open).  emit_faces() splits each
+// quad along the brighter diagonal, so the darkening stays symmetric
+// instead of streaking along a fixed one.  Light is the average over the
+// same voxels that are not solid, rounded to a level, which smooths it
+// across faces.  Cells outside any loaded chunk count as open sky.
+void mesher::shade_face(int x, int y, int z, face f,
+                        corner_shade shade[cube::face_corner_count]) const
+{
+    int axis = static_cast<int>(f) / 2;
+    const int *n = face_offsets[static_cast<int>(f)];
+
+    // The layer of voxels directly in front of the face
+    int front[3] = {x + n[0], y + n[1], z + n[2]};
+
+    for (int corner = 0; corner < cube::face_corner_count; corner++) {
+        const float *v = cube::face_corner(f, corner);
+
+        // Step from the front voxel towards this corner along each of the
+        // two axes in the face's plane.
+        int side1[3] = {front[0], front[1], front[2]};
+        int side2[3] = {front[0], front[1], front[2]};
+        int diagonal[3] = {front[0], front[1], front[2]};
+        bool first = true;
+        for (int a = 0; a < 3; a++) {
+            if (a == axis) {
+                continue;
+            }
+
+            int toward = v[a] > 0.5f ? 1 : -1;
+            if (first) {
+                side1[a] += toward;
+                first = false;
+            } else {
+                side2[a] += toward;
+            }
+            diagonal[a] += toward;
+        }
+
+        bool s1 = opaque(side1[0], side1[1], side1[2]);
+        bool s2 = opaque(side2[0], side2[1], side2[2]);
+        bool c = opaque(diagonal[0], diagonal[1], diagonal[2]);
+
+        if (s1 && s2) {
+            shade[corner].ao = 0;
+        } else {
+            shade[corner].ao = 3 - (s1 + s2 + c);
+        }
+
+        // The diagonal cannot be seen past two solid sides
+        int sky = 0;
+        int glow = 0;
+        int samples = 0;
+        const int *cells[4] = {front, side1, side2, diagonal};
+        bool open[4] = {true, !s1, !s2, !c && !(s1 && s2)};
+        for (int i = 0; i < 4; i++) {
+            if (!open[i]) {
+                continue;
+            }
+            uint8_t l = light_at(cells[i][0], cells[i][1], cells[i][2]);
+            sky += l >> 4;
+            glow += l & 0x0f;
+            samples++;
+        }
+
+        shade[corner].sky = (2 * sky + samples) / (2 * samples);
+        shade[corner].glow = (2 * glow + samples) / (2 * samples);
+    }
+}
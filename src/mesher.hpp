@@ -0,0 +1,110 @@
+#ifndef MESHER_HPP
+#define MESHER_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "cube.hpp"
+#include "world.hpp"
+
+// C Standard Headers
+#include <cstdint>
+
+// C++ Standard Headers
+#include <vector>
+
+/**
+ *  Builds the visible faces of one chunk section at a time
+ *
+ *  The section's blocks plus a one voxel border are first copied into a
+ *  flat padded array, so face culling never has to look up neighboring
+ *  chunks.  Each visible face becomes one record of two 32 bit words,
+ *  which the vertex shader expands into quad corners (vertex pulling):
+ *
+ *    word 0: x, y, z in the section (4 bits each), face (3), diagonal
+ *            flip (1), ambient occlusion per corner (2 bits each) and
+ *            the block (8)
+ *    word 1: sky and block light level per corner (4 bits each)
+ */
+class mesher {
+ public:
+    static const int extent = chunk::section_size;
+    static const int padded = extent + 2;
+    static const int face_words = 2;
+
+    // Most opaque faces a section can have: a checkerboard, each block
+    // with six.  Translucent faces between different blocks can exceed it.
+    static const int max_quads = extent * extent * extent / 2 * face_count;
+
+    enum class culling {
+        bitmask,
+        naive
+    };
+
+    explicit mesher(culling mode = culling::bitmask);
+
+    void mesh(const world& w,
+              const section_coord& coord,
+              std::vector<uint32_t>& faces,
+              std::vector<uint32_t>& translucent_faces);
+
+    // Center of the quad of a face record, from its first word, in
+    // section coordinates
+    static void face_center(uint32_t shape, float center[3]);
+
+ private:
+    static const int layer_count = 3;
+    typedef uint32_t face_masks[face_count][extent][extent];
+
+    bool gather(const world& w, const section_coord& coord);
+    void find_faces(int layer, face_masks& exposed, bool accumulate);
+    void find_faces_naive();
+    void emit_faces(const face_masks& exposed, std::vector<uint32_t>& faces);
+    struct corner_shade {
+        int ao;
+        int sky;
+        int glow;
+    };
+
+    void shade_face(int x, int y, int z, face f,
+                    corner_shade shade[cube::face_corner_count]) const;
+    bool opaque(int x, int y, int z) const;
+
+    block at(int x, int y, int z) const;
+    uint8_t light_at(int x, int y, int z) const;
+    static int padded_index(int x, int y, int z);
+
+    culling m_culling;
+
+    block m_blocks[padded * padded * padded];
+    uint8_t m_light[padded * padded * padded];
+
+    // Bit x of row [layer][y][z] is set if the padded cell holds a block
+    // of that layer, and bit x of exposed [f][y][z] if the section's block
+    // has face f showing
+    uint32_t m_rows[layer_count][padded][padded];
+    bool m_has_translucent;
+    face_masks m_exposed;
+    face_masks m_translucent_exposed;
+};
+
+inline int mesher::padded_index(int x, int y, int z)
+{
+    return ((y + 1) * padded + (z + 1)) * padded + (x + 1);
+}
+
+inline block mesher::at(int x, int y, int z) const
+{
+    return m_blocks[padded_index(x, y, z)];
+}
+
+inline uint8_t mesher::light_at(int x, int y, int z) const
+{
+    return m_light[padded_index(x, y, z)];
+}
+
+inline bool mesher::opaque(int x, int y, int z) const
+{
+    return block_opaque(at(x, y, z));
+}
+
+#endif // MESHER_HPP
@@ -0,0 +1,543 @@
+// Module Header
+#include "raycast.hpp"
+
+// External Headers
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// C Standard Headers
+#include <cmath>
+
+// C++ Standard Headers
+#include <limits>
+
+using namespace std;
+
+static const float s_infinity = numeric_limits<float>::infinity();
+
+static face entry_face(int axis, int step)
+{
+    // Moving in +axis enters a block through its negative face
+    return static_cast<face>(axis * 2 + (step > 0 ? 0 : 1));
+}
+
+static void init_traversal(const float o[3],
+                           const float d[3],
+                           int cell[3],
+                           int step[3],
+                           float t_max[3],
+                           float t_delta[3])
+{
+    for (int axis = 0; axis < 3; axis++) {
+        cell[axis] = (int)floorf(o[axis]);
+        if (d[axis] > 0.0f) {
+            step[axis] = 1;
+            t_delta[axis] = 1.0f / d[axis];
+            t_max[axis] = (cell[axis] + 1 - o[axis]) / d[axis];
+        } else if (d[axis] < 0.0f) {
+            step[axis] = -1;
+            t_delta[axis] = -1.0f / d[axis];
+            t_max[axis] = (cell[axis] - o[axis]) / d[axis];
+        } else {
+            step[axis] = 0;
+            t_delta[axis] = s_infinity;
+            t_max[axis] = s_infinity;
+        }
+    }
+}
+
+static int inside_axis(const float d[3])
+{
+    // A ray starting inside a block reports the face facing back along
+    // its dominant direction of travel.
+    int axis = 0;
+    for (int a = 1; a < 3; a++) {
+        if (fabsf(d[a]) > fabsf(d[axis])) {
+            axis = a;
+        }
+    }
+    return axis;
+}
+
+// Nothing to hit in the chunk at `base`: move the traversal straight to
+// the first cell past where the ray leaves it.  Returns false if that is
+// beyond max_distance.
+static bool skip_chunk(const float o[3],
+                       const float d[3],
+                       const int step[3],
+                       const int base[3],
+                       float max_distance,
+                       float& t,
+                       int cell[3],
+                       float t_max[3],
+                       int& entered_axis)
+{
+    float t_exit = s_infinity;
+    int exit_axis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (step[axis] == 0) {
+            continue;
+        }
+
+        float boundary = step[axis] > 0 ? base[axis] + chunk::size : base[axis];
+        float te = (boundary - o[axis]) / d[axis];
+        if (te < t_exit) {
+            t_exit = te;
+            exit_axis = axis;
+        }
+    }
+
+    if (exit_axis < 0 || t_exit > max_distance) {
+        return false;
+    }
+
+    t = t_exit;
+    entered_axis = exit_axis;
+    for (int axis = 0; axis < 3; axis++) {
+        if (axis == exit_axis) {
+            cell[axis] = step[axis] > 0 ? base[axis] + chunk::size : base[axis] - 1;
+        } else {
+            int v = (int)floorf(o[axis] + d[axis] * t);
+            if (v < base[axis]) {
+                v = base[axis];
+            } else if (v >= base[axis] + chunk::size) {
+                v = base[axis] + chunk::size - 1;
+            }
+            cell[axis] = v;
+        }
+
+        if (step[axis] > 0) {
+            t_max[axis] = (cell[axis] + 1 - o[axis]) / d[axis];
+        } else if (step[axis] < 0) {
+            t_max[axis] = (cell[axis] - o[axis]) / d[axis];
+        }
+    }
+
+    return true;
+}
+
+bool raycast(const world& w,
+             const glm::vec3& origin,
+             const glm::vec3& dir,
+             float max_distance,
+             raycast_hit& hit)
+{
+    hit.hit = false;
+
+    const float o[3] = {origin.x, origin.y, origin.z};
+    const float d[3] = {dir.x, dir.y, dir.z};
+
+    int cell[3];
+    int step[3];
+    float t_max[3];
+    float t_delta[3];
+    init_traversal(o, d, cell, step, t_max, t_delta);
+
+    float t = 0.0f;
+    int entered_axis = -1;
+
+    // Chunk containing `cell`, and the cell's offset and index within it.
+    // Stepping only touches `local` and `index`; the chunk map is consulted
+    // again only when the ray crosses into another chunk.
+    static const int stride[3] = {1, chunk::size * chunk::size, chunk::size};
+    int base[3];
+    int local[3];
+    int index = 0;
+    const block *blocks = nullptr;
+    bool in_chunk = false;
+
+    while (true) {
+        if (!in_chunk) {
+            chunk_coord cc = world::chunk_of(cell[0], cell[1], cell[2]);
+            base[0] = cc.x * chunk::size;
+            base[1] = cc.y * chunk::size;
+            base[2] = cc.z * chunk::size;
+
+            const chunk *c = w.find_chunk(cc);
+            if (c == nullptr || c->empty()) {
+                if (!skip_chunk(o, d, step, base, max_distance, t, cell, t_max, entered_axis)) {
+                    return false;
+                }
+                continue;
+            }
+
+            blocks = c->data();
+            for (int axis = 0; axis < 3; axis++) {
+                local[axis] = cell[axis] - base[axis];
+            }
+            index = chunk::index(local[0], local[1], local[2]);
+            in_chunk = true;
+        }
+
+        block b = blocks[index];
+        if (b != block::air) {
+            if (entered_axis < 0) {
+                entered_axis = inside_axis(d);
+            }
+
+            hit.hit = true;
+            hit.position[0] = cell[0];
+            hit.position[1] = cell[1];
+            hit.position[2] = cell[2];
+            hit.normal_face = entry_face(entered_axis, d[entered_axis] > 0.0f ? 1 : -1);
+            hit.distance = t;
+            hit.type = b;
+            return true;
+        }
+
+        int axis = 0;
+        if (t_max[1] < t_max[axis]) {
+            axis = 1;
+        }
+        if (t_max[2] < t_max[axis]) {
+            axis = 2;
+        }
+
+        t = t_max[axis];
+        if (t > max_distance) {
+            return false;
+        }
+
+        cell[axis] += step[axis];
+        t_max[axis] += t_delta[axis];
+        entered_axis = axis;
+
+        local[axis] += step[axis];
+        index += step[axis] * stride[axis];
+        if ((unsigned)local[axis] >= (unsigned)chunk::size) {
+            in_chunk = false;
+        }
+    }
+}
+
+void raycast_hits::resize(size_t count)
+{
+    hit.resize(count);
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    normal_face.resize(count);
+    distance.resize(count);
+    type.resize(count);
+}
+
+size_t raycast_hits::size() const
+{
+    return hit.size();
+}
+
+/**
+ *  Traversal state for one packet, one array element per lane
+ *
+ *  Besides the DDA state each lane tracks its cell's offset and flat
+ *  index within the current chunk, updated by the SIMD step, so a lane
+ *  that stays inside one chunk reads its next voxel with a single load.
+ */
+struct ray_packet {
+    static const int width = raycast_packet_width;
+
+    alignas(16) float t_max[3][width];
+    alignas(16) float t_delta[3][width];
+    alignas(16) int32_t cell[3][width];
+    alignas(16) int32_t step[3][width];
+    alignas(16) int32_t local[3][width];
+    alignas(16) int32_t index_step[3][width];
+    alignas(16) int32_t index[width];
+    alignas(16) float t[width];
+    alignas(16) int32_t entered[width];
+
+    float o[width][3];
+    float d[width][3];
+    size_t ray[width];
+
+    int base[width][3];
+    const block *blocks[width];
+
+    // Bit per lane
+    unsigned active;
+    unsigned in_chunk;
+};
+
+static const unsigned s_all_lanes = (1u << raycast_packet_width) - 1;
+
+static const int s_index_stride[3] = {1, chunk::size * chunk::size, chunk::size};
+
+static void load_lane(ray_packet& p, int lane, size_t ray,
+                      const glm::vec3& origin, const glm::vec3& dir)
+{
+    float *o = p.o[lane];
+    float *d = p.d[lane];
+    o[0] = origin.x;
+    o[1] = origin.y;
+    o[2] = origin.z;
+    d[0] = dir.x;
+    d[1] = dir.y;
+    d[2] = dir.z;
+
+    int cell[3];
+    int step[3];
+    float t_max[3];
+    float t_delta[3];
+    init_traversal(o, d, cell, step, t_max, t_delta);
+
+    for (int axis = 0; axis < 3; axis++) {
+        p.cell[axis][lane] = cell[axis];
+        p.step[axis][lane] = step[axis];
+        p.index_step[axis][lane] = step[axis] * s_index_stride[axis];
+        p.local[axis][lane] = 0;
+        p.t_max[axis][lane] = t_max[axis];
+        p.t_delta[axis][lane] = t_delta[axis];
+    }
+    p.index[lane] = 0;
+    p.t[lane] = 0.0f;
+    p.entered[lane] = -1;
+    p.ray[lane] = ray;
+    p.active |= 1u << lane;
+    p.in_chunk &= ~(1u << lane);
+}
+
+static void park_lane(ray_packet& p, int lane)
+{
+    // Freeze the lane so the SIMD step can run over it harmlessly
+    p.active &= ~(1u << lane);
+    p.in_chunk &= ~(1u << lane);
+    for (int axis = 0; axis < 3; axis++) {
+        p.step[axis][lane] = 0;
+        p.index_step[axis][lane] = 0;
+        p.t_delta[axis][lane] = 0.0f;
+    }
+}
+
+// Slow path of visit_lane(): the lane has entered a new chunk.  Skips
+// empty chunks and sets up the lane's chunk-local position.  Returns
+// false if the ray ran out of distance.
+static bool enter_chunk(const world& w, ray_packet& p, int lane, float max_distance)
+{
+    int *base = p.base[lane];
+
+    while (true) {
+        int cell[3] = {p.cell[0][lane], p.cell[1][lane], p.cell[2][lane]};
+
+        chunk_coord cc = world::chunk_of(cell[0], cell[1], cell[2]);
+        base[0] = cc.x * chunk::size;
+        base[1] = cc.y * chunk::size;
+        base[2] = cc.z * chunk::size;
+
+        const chunk *c = w.find_chunk(cc);
+        if (c != nullptr && !c->empty()) {
+            p.blocks[lane] = c->data();
+            for (int axis = 0; axis < 3; axis++) {
+                p.local[axis][lane] = cell[axis] - base[axis];
+            }
+            p.index[lane] = chunk::index(p.local[0][lane], p.local[1][lane], p.local[2][lane]);
+            p.in_chunk |= 1u << lane;
+            return true;
+        }
+
+        int step[3] = {p.step[0][lane], p.step[1][lane], p.step[2][lane]};
+        float t_max[3];
+        int entered = p.entered[lane];
+        if (!skip_chunk(p.o[lane], p.d[lane], step, base, max_distance,
+                        p.t[lane], cell, t_max, entered)) {
+            return false;
+        }
+
+        for (int axis = 0; axis < 3; axis++) {
+            p.cell[axis][lane] = cell[axis];
+            if (step[axis] != 0) {
+                p.t_max[axis][lane] = t_max[axis];
+            }
+        }
+        p.entered[lane] = entered;
+    }
+}
+
+// Looks at the lane's current cell.  Returns true if the lane is done,
+// having either hit something or run out of distance.
+static bool visit_lane(const world& w, ray_packet& p, int lane,
+                       float max_distance, raycast_hits& hits)
+{
+    size_t r = p.ray[lane];
+
+    if ((p.in_chunk & (1u << lane)) == 0 && !enter_chunk(w, p, lane, max_distance)) {
+        hits.hit[r] = 0;
+        return true;
+    }
+
+    block b = p.blocks[lane][p.index[lane]];
+    if (b == block::air) {
+        return false;
+    }
+
+    int entered = p.entered[lane];
+    if (entered < 0) {
+        entered = inside_axis(p.d[lane]);
+    }
+
+    hits.hit[r] = 1;
+    hits.x[r] = p.cell[0][lane];
+    hits.y[r] = p.cell[1][lane];
+    hits.z[r] = p.cell[2][lane];
+    hits.normal_face[r] = entry_face(entered, p.d[lane][entered] > 0.0f ? 1 : -1);
+    hits.distance[r] = p.t[lane];
+    hits.type[r] = b;
+    return true;
+}
+
+// One DDA step for every lane: pick the axis with the smallest t_max
+// (ties resolved exactly as in raycast()), then advance t, the cell, the
+// chunk-local position and t_max.  Lanes that step out of their chunk
+// have in_chunk cleared.
+static void step_packet(ray_packet& p)
+{
+#if defined(__SSE2__)
+    __m128 tx = _mm_load_ps(p.t_max[0]);
+    __m128 ty = _mm_load_ps(p.t_max[1]);
+    __m128 tz = _mm_load_ps(p.t_max[2]);
+
+    __m128 pick_y = _mm_cmplt_ps(ty, tx);
+    __m128 t_xy = _mm_or_ps(_mm_and_ps(pick_y, ty), _mm_andnot_ps(pick_y, tx));
+    __m128 pick_z = _mm_cmplt_ps(tz, t_xy);
+    __m128 t_new = _mm_or_ps(_mm_and_ps(pick_z, tz), _mm_andnot_ps(pick_z, t_xy));
+    pick_y = _mm_andnot_ps(pick_z, pick_y);
+    __m128 pick_x = _mm_andnot_ps(_mm_or_ps(pick_y, pick_z), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+    _mm_store_ps(p.t, t_new);
+
+    const __m128i below = _mm_set1_epi32(0);
+    const __m128i above = _mm_set1_epi32(chunk::size - 1);
+    __m128i index = _mm_load_si128((const __m128i *)p.index);
+    __m128i outside = _mm_setzero_si128();
+
+    __m128 picks[3] = {pick_x, pick_y, pick_z};
+    for (int axis = 0; axis < 3; axis++) {
+        __m128i mask = _mm_castps_si128(picks[axis]);
+
+        __m128i step = _mm_and_si128(mask, _mm_load_si128((const __m128i *)p.step[axis]));
+        __m128i cell = _mm_load_si128((const __m128i *)p.cell[axis]);
+        __m128i local = _mm_load_si128((const __m128i *)p.local[axis]);
+        _mm_store_si128((__m128i *)p.cell[axis], _mm_add_epi32(cell, step));
+        local = _mm_add_epi32(local, step);
+        _mm_store_si128((__m128i *)p.local[axis], local);
+
+        outside = _mm_or_si128(outside, _mm_cmplt_epi32(local, below));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(local, above));
+
+        __m128i index_step = _mm_load_si128((const __m128i *)p.index_step[axis]);
+        index = _mm_add_epi32(index, _mm_and_si128(mask, index_step));
+
+        __m128 t_max = _mm_load_ps(p.t_max[axis]);
+        __m128 t_delta = _mm_load_ps(p.t_delta[axis]);
+        t_max = _mm_add_ps(t_max, _mm_and_ps(picks[axis], t_delta));
+        _mm_store_ps(p.t_max[axis], t_max);
+    }
+    _mm_store_si128((__m128i *)p.index, index);
+
+    __m128i entered = _mm_or_si128(_mm_and_si128(_mm_castps_si128(pick_y), _mm_set1_epi32(1)),
+                                   _mm_and_si128(_mm_castps_si128(pick_z), _mm_set1_epi32(2)));
+    _mm_store_si128((__m128i *)p.entered, entered);
+
+    p.in_chunk &= ~(unsigned)_mm_movemask_ps(_mm_castsi128_ps(outside));
+#else
+    for (int lane = 0; lane < ray_packet::width; lane++) {
+        int axis = 0;
+        if (p.t_max[1][lane] < p.t_max[axis][lane]) {
+            axis = 1;
+        }
+        if (p.t_max[2][lane] < p.t_max[axis][lane]) {
+            axis = 2;
+        }
+
+        p.t[lane] = p.t_max[axis][lane];
+        p.cell[axis][lane] += p.step[axis][lane];
+        p.local[axis][lane] += p.step[axis][lane];
+        p.index[lane] += p.index_step[axis][lane];
+        p.t_max[axis][lane] += p.t_delta[axis][lane];
+        p.entered[lane] = axis;
+
+        if ((unsigned)p.local[axis][lane] >= (unsigned)chunk::size) {
+            p.in_chunk &= ~(1u << lane);
+        }
+    }
+#endif
+}
+
+void raycast_batch(const world& w,
+                   const glm::vec3 *origins,
+                   const glm::vec3 *dirs,
+                   size_t count,
+                   float max_distance,
+                   raycast_hits& hits)
+{
+    hits.resize(count);
+
+    // Lanes are refilled from the input as soon as their ray finishes, so
+    // one long ray doesn't leave the rest of the packet idle.
+    ray_packet p;
+    p.active = 0;
+    p.in_chunk = 0;
+
+    size_t next = 0;
+    for (int lane = 0; lane < ray_packet::width; lane++) {
+        if (next < count) {
+            load_lane(p, lane, next, origins[next], dirs[next]);
+            next++;
+        } else {
+            load_lane(p, lane, 0, glm::vec3(0.0f), glm::vec3(0.0f));
+            park_lane(p, lane);
+        }
+    }
+
+    while (p.active != 0) {
+        // Common case: every lane is inside a loaded chunk and sees air,
+        // which is one gather and one test for the whole packet.
+        bool all_air = false;
+        if (p.in_chunk == s_all_lanes) {
+            block seen = block::air;
+            for (int lane = 0; lane < ray_packet::width; lane++) {
+                seen = static_cast<block>(static_cast<uint8_t>(seen) |
+                                          static_cast<uint8_t>(p.blocks[lane][p.index[lane]]));
+            }
+            all_air = seen == block::air;
+        }
+
+        if (!all_air) {
+            for (int lane = 0; lane < ray_packet::width; lane++) {
+                while ((p.active & (1u << lane)) != 0 &&
+                       visit_lane(w, p, lane, max_distance, hits)) {
+                    if (next < count) {
+                        load_lane(p, lane, next, origins[next], dirs[next]);
+                        next++;
+                    } else {
+                        park_lane(p, lane);
+                    }
+                }
+            }
+        }
+
+        step_packet(p);
+
+        unsigned expired = 0;
+        for (int lane = 0; lane < ray_packet::width; lane++) {
+            if (p.t[lane] > max_distance) {
+                expired |= 1u << lane;
+            }
+        }
+        expired &= p.active;
+
+        for (int lane = 0; expired != 0; lane++, expired >>= 1) {
+            if ((expired & 1) == 0) {
+                continue;
+            }
+
+            hits.hit[p.ray[lane]] = 0;
+            if (next < count) {
+                load_lane(p, lane, next, origins[next], dirs[next]);
+                next++;
+            } else {
+                park_lane(p, lane);
+            }
+        }
+    }
+}
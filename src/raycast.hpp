@@ -0,0 +1,84 @@
+#ifndef RAYCAST_HPP
+#define RAYCAST_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "world.hpp"
+
+// External Headers
+#include <glm/glm.hpp>
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <vector>
+
+/**
+ *  Result of a voxel raycast
+ *
+ *  `position` is the solid block that was hit and `normal_face` the face
+ *  of it the ray entered through, so the empty cell in front of the hit
+ *  is position + face_offsets[normal_face].  A ray starting inside a
+ *  solid block hits it at distance zero.
+ */
+struct raycast_hit {
+    bool hit;
+    int position[3];
+    face normal_face;
+    float distance;
+    block type;
+};
+
+/**
+ *  Amanatides-Woo traversal of the voxel grid from `origin` along `dir`
+ *
+ *  Visits every cell the ray passes through, in order, up to
+ *  `max_distance` (in units of |dir|, so pass a normalized direction for
+ *  world units).  Chunks that are missing or empty are crossed in a
+ *  single step rather than cell by cell.
+ */
+bool raycast(const world& w,
+             const glm::vec3& origin,
+             const glm::vec3& dir,
+             float max_distance,
+             raycast_hit& hit);
+
+/**
+ *  Structure-of-arrays results of raycast_batch(), one entry per ray
+ *
+ *  Fields mean the same as in raycast_hit; entries whose `hit` is zero
+ *  leave the other fields unspecified.
+ */
+struct raycast_hits {
+    std::vector<uint8_t> hit;
+    std::vector<int32_t> x;
+    std::vector<int32_t> y;
+    std::vector<int32_t> z;
+    std::vector<face> normal_face;
+    std::vector<float> distance;
+    std::vector<block> type;
+
+    void resize(size_t count);
+    size_t size() const;
+};
+
+static const int raycast_packet_width = 4;
+
+/**
+ *  Casts many rays, traversing them in packets of raycast_packet_width
+ *
+ *  Each lane of a packet runs the same traversal as raycast(), and gets
+ *  identical results, but the DDA step (choosing the axis, advancing t
+ *  and the cell) is done for the whole packet at once with SIMD.  Voxel
+ *  lookups and empty-chunk skips stay per lane.
+ */
+void raycast_batch(const world& w,
+                   const glm::vec3 *origins,
+                   const glm::vec3 *dirs,
+                   size_t count,
+                   float max_distance,
+                   raycast_hits& hits);
+
+#endif // RAYCAST_HPP
@@ -0,0 +1,386 @@
+// Module Header
+#include "region_file.hpp"
+
+// Local Headers
+#include "chunk_codec.hpp"
+
+// External Headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C Standard Headers
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// C++ Standard Headers
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const uint32_t s_region_magic = 0x47525856; // "VXRG"
+static const uint32_t s_region_version = 1;
+
+// Don't bother rewriting a file to reclaim less than this
+static const size_t s_min_compact_garbage = 64 * 1024;
+
+class region_open_exception : public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error opening region file.";
+    }
+} region_open_ex;
+
+class region_format_exception : public exception {
+    virtual const char* what() const throw()
+    {
+        return "Region file is corrupt or has an unknown format.";
+    }
+} region_format_ex;
+
+class region_io_exception : public exception {
+    virtual const char* what() const throw()
+    {
+        return "Error reading or writing region file.";
+    }
+} region_io_ex;
+
+static void write_all(int fd, const void *data, size_t length, off_t offset)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (length > 0) {
+        ssize_t written = pwrite(fd, p, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw region_io_ex;
+        }
+
+        p += written;
+        offset += written;
+        length -= written;
+    }
+}
+
+region_file::region_file(const string& path) :
+    m_path(path),
+    m_fd(-1),
+    m_map(nullptr),
+    m_map_size(0),
+    m_file_size(0),
+    m_live_bytes(0)
+{
+    open_file();
+}
+
+region_file::~region_file()
+{
+    close_file();
+}
+
+bool region_file::contains(int slot) const
+{
+    assert(slot >= 0 && slot < slot_count);
+    return m_header.entries[slot].length != 0;
+}
+
+bool region_file::read_chunk(int slot, chunk& c)
+{
+    uint32_t length;
+    const uint8_t *data = payload(slot, length);
+    if (data == nullptr) {
+        return false;
+    }
+
+    if (!chunk_codec::decode(data, length, c)) {
+        throw region_format_ex;
+    }
+
+    return true;
+}
+
+void region_file::write_chunk(int slot, const chunk& c)
+{
+    vector<uint8_t> encoded;
+    chunk_codec::encode(c, encoded);
+    write_payload(slot, encoded.data(), encoded.size());
+}
+
+void region_file::write_payload(int slot, const uint8_t *data, uint32_t length)
+{
+    assert(slot >= 0 && slot < slot_count);
+    assert(length != 0);
+
+    // Payload first, then the table entry, so a torn write leaves the
+    // old chunk reachable rather than a pointer to half a payload.
+    uint32_t offset = m_file_size;
+    write_all(m_fd, data, length, offset);
+    m_file_size += length;
+
+    entry& e = m_header.entries[slot];
+    m_live_bytes -= e.length;
+    e.offset = offset;
+    e.length = length;
+    m_live_bytes += length;
+
+    write_all(m_fd, &e, sizeof(e), offsetof(header, entries) + slot * sizeof(entry));
+}
+
+void region_file::write_payloads(const int *slots,
+                                 const vector<uint8_t> *payloads,
+                                 size_t count)
+{
+    // Coalesced form of write_payload(): one append for all payloads and
+    // one rewrite of the entry table, instead of two writes per chunk.
+    vector<uint8_t> buffer;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += payloads[i].size();
+    }
+    buffer.reserve(total);
+
+    uint32_t offset = m_file_size;
+    for (size_t i = 0; i < count; i++) {
+        assert(slots[i] >= 0 && slots[i] < slot_count);
+        assert(!payloads[i].empty());
+
+        entry& e = m_header.entries[slots[i]];
+        m_live_bytes -= e.length;
+        e.offset = offset + buffer.size();
+        e.length = payloads[i].size();
+        m_live_bytes += e.length;
+
+        buffer.insert(buffer.end(), payloads[i].begin(), payloads[i].end());
+    }
+
+    write_all(m_fd, buffer.data(), buffer.size(), offset);
+    m_file_size += buffer.size();
+
+    write_all(m_fd, m_header.entries, sizeof(m_header.entries),
+              offsetof(header, entries));
+}
+
+const uint8_t *region_file::payload(int slot, uint32_t& length)
+{
+    assert(slot >= 0 && slot < slot_count);
+
+    const entry& e = m_header.entries[slot];
+    if (e.length == 0) {
+        length = 0;
+        return nullptr;
+    }
+
+    // Appends grow the file past the mapping; remap lazily on first read
+    if (static_cast<size_t>(e.offset) + e.length > m_map_size) {
+        map_file();
+    }
+
+    length = e.length;
+    return m_map + e.offset;
+}
+
+void region_file::prefetch(const int *slots, size_t count)
+{
+    // Ask for the whole span covering a batch of reads at once, so the
+    // kernel issues one large read rather than faulting chunk by chunk.
+    size_t first = m_file_size;
+    size_t last = 0;
+    for (size_t i = 0; i < count; i++) {
+        const entry& e = m_header.entries[slots[i]];
+        if (e.length == 0) {
+            continue;
+        }
+
+        if (e.offset < first) {
+            first = e.offset;
+        }
+        if (e.offset + e.length > last) {
+            last = e.offset + e.length;
+        }
+    }
+
+    if (first >= last) {
+        return;
+    }
+
+    if (last > m_map_size) {
+        map_file();
+    }
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t aligned = first & ~(page - 1);
+    madvise(m_map + aligned, last - aligned, MADV_WILLNEED);
+}
+
+void region_file::compact()
+{
+    if (garbage_bytes() == 0) {
+        return;
+    }
+
+    map_file();
+
+    string tmp_path = m_path + ".tmp";
+    int tmp_fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tmp_fd < 0) {
+        throw region_open_ex;
+    }
+
+    header compacted = m_header;
+    size_t offset = sizeof(header);
+    for (int i = 0; i < slot_count; i++) {
+        entry& e = compacted.entries[i];
+        if (e.length == 0) {
+            continue;
+        }
+
+        write_all(tmp_fd, m_map + e.offset, e.length, offset);
+        e.offset = offset;
+        offset += e.length;
+    }
+    write_all(tmp_fd, &compacted, sizeof(compacted), 0);
+
+    if (fsync(tmp_fd) < 0 || close(tmp_fd) < 0) {
+        throw region_io_ex;
+    }
+
+    close_file();
+    int status = rename(tmp_path.c_str(), m_path.c_str());
+    open_file();
+
+    if (status < 0) {
+        throw region_io_ex;
+    }
+}
+
+bool region_file::wants_compaction() const
+{
+    size_t garbage = garbage_bytes();
+    return garbage >= s_min_compact_garbage && garbage > m_live_bytes;
+}
+
+size_t region_file::live_bytes() const
+{
+    return m_live_bytes;
+}
+
+size_t region_file::garbage_bytes() const
+{
+    return m_file_size - sizeof(header) - m_live_bytes;
+}
+
+const string& region_file::path() const
+{
+    return m_path;
+}
+
+chunk_coord region_file::region_of(const chunk_coord& coord)
+{
+    return chunk_coord{floor_div(coord.x, size),
+                       floor_div(coord.y, size),
+                       floor_div(coord.z, size)};
+}
+
+int region_file::slot_of(const chunk_coord& coord)
+{
+    int x = floor_mod(coord.x, size);
+    int y = floor_mod(coord.y, size);
+    int z = floor_mod(coord.z, size);
+    return (y * size + z) * size + x;
+}
+
+chunk_coord region_file::chunk_at(const chunk_coord& region, int slot)
+{
+    return chunk_coord{region.x * size + slot % size,
+                       region.y * size + slot / (size * size),
+                       region.z * size + (slot / size) % size};
+}
+
+void region_file::open_file()
+{
+    m_fd = open(m_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0) {
+        throw region_open_ex;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) < 0) {
+        close_file();
+        throw region_io_ex;
+    }
+    m_file_size = st.st_size;
+
+    if (m_file_size == 0) {
+        memset(&m_header, 0, sizeof(m_header));
+        m_header.magic = s_region_magic;
+        m_header.version = s_region_version;
+        write_all(m_fd, &m_header, sizeof(m_header), 0);
+        m_file_size = sizeof(m_header);
+    } else if (m_file_size < sizeof(m_header) ||
+               pread(m_fd, &m_header, sizeof(m_header), 0) != sizeof(m_header) ||
+               m_header.magic != s_region_magic ||
+               m_header.version != s_region_version) {
+        close_file();
+        throw region_format_ex;
+    }
+
+    m_live_bytes = 0;
+    for (int i = 0; i < slot_count; i++) {
+        const entry& e = m_header.entries[i];
+        if (e.length == 0) {
+            continue;
+        }
+
+        if (e.offset < sizeof(m_header) ||
+            static_cast<size_t>(e.offset) + e.length > m_file_size) {
+            close_file();
+            throw region_format_ex;
+        }
+        m_live_bytes += e.length;
+    }
+
+    map_file();
+}
+
+void region_file::close_file()
+{
+    unmap_file();
+
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void region_file::map_file()
+{
+    if (m_map_size == m_file_size) {
+        return;
+    }
+
+    unmap_file();
+
+    void *addr = mmap(nullptr, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED) {
+        throw region_io_ex;
+    }
+
+    m_map = static_cast<uint8_t *>(addr);
+    m_map_size = m_file_size;
+}
+
+void region_file::unmap_file()
+{
+    if (m_map != nullptr) {
+        munmap(m_map, m_map_size);
+        m_map = nullptr;
+        m_map_size = 0;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef REGION_FILE_HPP
+#define REGION_FILE_HPP
+
+// Local Headers
+#include "chunk.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <string>
+#include <vector>
+
+/**
+ *  One on-disk file holding a size^3 block of compressed chunks
+ *
+ *  Layout: a fixed header (magic, version, one {offset, length} entry per
+ *  chunk slot) followed by chunk payloads.  Reads go through a read-only
+ *  mmap of the file, so fetching any chunk is a table lookup plus a
+ *  decode.  Writes always append a new payload and then repoint the
+ *  table entry; superseded payloads become garbage that compact()
+ *  reclaims by rewriting the file.
+ */
+class region_file {
+ public:
+    static const int size = 8;
+    static const int slot_count = size * size * size;
+
+    explicit region_file(const std::string& path);
+    ~region_file();
+
+    region_file(const region_file&) = delete;
+    region_file& operator=(const region_file&) = delete;
+
+    bool contains(int slot) const;
+    bool read_chunk(int slot, chunk& c);
+    void write_chunk(int slot, const chunk& c);
+    void write_payload(int slot, const uint8_t *data, uint32_t length);
+    void write_payloads(const int *slots,
+                        const std::vector<uint8_t> *payloads,
+                        size_t count);
+    const uint8_t *payload(int slot, uint32_t& length);
+    void prefetch(const int *slots, size_t count);
+
+    void compact();
+    bool wants_compaction() const;
+    size_t live_bytes() const;
+    size_t garbage_bytes() const;
+    const std::string& path() const;
+
+    static chunk_coord region_of(const chunk_coord& coord);
+    static int slot_of(const chunk_coord& coord);
+    static chunk_coord chunk_at(const chunk_coord& region, int slot);
+
+ private:
+    struct entry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct header {
+        uint32_t magic;
+        uint32_t version;
+        entry entries[slot_count];
+    };
+
+    void open_file();
+    void close_file();
+    void map_file();
+    void unmap_file();
+
+    std::string m_path;
+    int m_fd;
+    uint8_t *m_map;
+    size_t m_map_size;
+    size_t m_file_size;
+    size_t m_live_bytes;
+    header m_header;
+};
+
+#endif // REGION_FILE_HPP
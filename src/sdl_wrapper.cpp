@@ -65,7 +65,7 @@ sdk::~sdk()
     SDL_Quit();
 }
 
-sdl_window::sdl_window(int width, int height)
+sdl_window::sdl_window(int width, int height, bool debug_context)
 {
     if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3) < 0) {
         throw window_ex;
@@ -79,6 +79,11 @@ sdl_window::sdl_window(int width, int height)
         throw window_ex;
     }
 
+    // Debug contexts report everything, at some cost to speed
+    if (debug_context && SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG) < 0) {
+        throw window_ex;
+    }
+
     // Create main window
     m_window = SDL_CreateWindow("OpenGL Tutorial",
                                 SDL_WINDOWPOS_UNDEFINED,
@@ -111,14 +116,24 @@ opengl_context::~opengl_context()
     SDL_GL_DeleteContext(m_context);
 }
 
-wrapper::wrapper(int width, int height) :
-    m_window(width, height),
-    m_context(m_window.m_window)
+const char *swap_mode_name(swap_mode mode)
 {
-    if (SDL_GL_SetSwapInterval(1) < 0) {
-        throw swap_ex;
+    switch (mode) {
+        case swap_mode::adaptive:   return "adaptive vsync";
+        case swap_mode::uncapped:   return "uncapped";
+        case swap_mode::vsync:      return "vsync";
     }
 
+    return "unknown";
+}
+
+wrapper::wrapper(int width, int height, swap_mode mode, bool debug_context) :
+    m_window(width, height, debug_context),
+    m_context(m_window.m_window),
+    m_swap_mode(mode)
+{
+    set_swap_mode(mode);
+
     if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
         throw swap_ex;
     }
@@ -132,4 +147,23 @@ SDL_Window* wrapper::window()
     return m_window.m_window;
 }
 
+void wrapper::set_swap_mode(swap_mode mode)
+{
+    if (SDL_GL_SetSwapInterval(static_cast<int>(mode)) == 0) {
+        m_swap_mode = mode;
+        return;
+    }
+
+    if (mode != swap_mode::adaptive) {
+        throw swap_ex;
+    }
+
+    set_swap_mode(swap_mode::vsync);
+}
+
+swap_mode wrapper::current_swap_mode() const
+{
+    return m_swap_mode;
+}
+
 } // namespace sdl_wrapper
@@ -22,7 +22,7 @@ class sdl_window {
     friend class wrapper;
 
  private:
-    sdl_window(int width, int height);
+    sdl_window(int width, int height, bool debug_context);
     ~sdl_window();
 
     SDL_Window* m_window;
@@ -38,15 +38,37 @@ class opengl_context {
     SDL_GLContext m_context;
 };
 
+/**
+ *  How buffer swaps wait for the display; values are SDL swap intervals
+ *
+ *  Adaptive sync waits for vblank unless the frame is already late, in
+ *  which case it tears instead of dropping to half rate.  Not every
+ *  driver supports it; set_swap_mode() falls back to plain vsync.
+ */
+enum class swap_mode {
+    adaptive = -1,
+    uncapped = 0,
+    vsync = 1
+};
+
+const char *swap_mode_name(swap_mode mode);
+
 class wrapper {
  public:
-    wrapper(int width, int height);
+    wrapper(int width,
+            int height,
+            swap_mode mode = swap_mode::vsync,
+            bool debug_context = false);
     SDL_Window* window();
 
+    void set_swap_mode(swap_mode mode);
+    swap_mode current_swap_mode() const;
+
  private:
     sdk m_sdk;
     sdl_window m_window;
     opengl_context m_context;
+    swap_mode m_swap_mode;
 };
 
 } // namespace sdl_wrapper
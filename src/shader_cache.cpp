@@ -0,0 +1,62 @@
+// Module Header
+#include "shader_cache.hpp"
+
+// C++ Standard Headers
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+shader_cache::shader_cache(const string& vertex_filename,
+                           const string& fragment_filename,
+                           const vector<string>& feature_defines) :
+    m_vertex_filename(vertex_filename),
+    m_fragment_filename(fragment_filename),
+    m_feature_defines(feature_defines),
+    m_watcher(nullptr)
+{
+}
+
+gl_wrapper::shader_program& shader_cache::get(uint32_t key)
+{
+    unique_ptr<gl_wrapper::shader_program>& slot = m_variants[key];
+    if (slot) {
+        return *slot;
+    }
+
+    vector<string> defines;
+    for (size_t i = 0; i < m_feature_defines.size(); i++) {
+        if (key & (1u << i)) {
+            defines.push_back(m_feature_defines[i]);
+        }
+    }
+
+    // Compile errors leave no empty entry behind
+    try {
+        slot = make_unique<gl_wrapper::shader_program>(m_vertex_filename,
+                                                       m_fragment_filename,
+                                                       defines);
+    } catch (...) {
+        m_variants.erase(key);
+        throw;
+    }
+
+    if (m_watcher != nullptr) {
+        m_watcher->watch(*slot);
+    }
+    return *slot;
+}
+
+size_t shader_cache::size() const
+{
+    return m_variants.size();
+}
+
+void shader_cache::watch(shader_watcher& watcher)
+{
+    m_watcher = &watcher;
+    for (auto& entry : m_variants) {
+        watcher.watch(*entry.second);
+    }
+}
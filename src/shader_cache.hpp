@@ -0,0 +1,50 @@
+#ifndef SHADER_CACHE_HPP
+#define SHADER_CACHE_HPP
+
+// Local Headers
+#include "gl_wrapper.hpp"
+#include "shader_watcher.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ *  Variants of one shader program, specialized by compile-time features
+ *
+ *  A variant's key is a bit set of features, and bit i turns on the i-th
+ *  define given to the constructor.  Each variant is compiled the first
+ *  time it is asked for and kept until the cache is destroyed, so
+ *  switching features back and forth costs a map lookup.  Once watch()
+ *  has been called every variant, present or future, hot reloads.
+ */
+class shader_cache {
+ public:
+    shader_cache(const std::string& vertex_filename,
+                 const std::string& fragment_filename,
+                 const std::vector<std::string>& feature_defines);
+
+    shader_cache(const shader_cache&) = delete;
+    shader_cache& operator=(const shader_cache&) = delete;
+
+    gl_wrapper::shader_program& get(uint32_t key);
+    size_t size() const;
+
+    void watch(shader_watcher& watcher);
+
+ private:
+    std::string m_vertex_filename;
+    std::string m_fragment_filename;
+    std::vector<std::string> m_feature_defines;
+
+    std::unordered_map<uint32_t, std::unique_ptr<gl_wrapper::shader_program>> m_variants;
+    shader_watcher *m_watcher;
+};
+
+#endif // SHADER_CACHE_HPP
@@ -0,0 +1,123 @@
+// Module Header
+#include "shader_watcher.hpp"
+
+// External Headers
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// C Standard Headers
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+static const uint32_t s_watch_events = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+static void split_path(const string& filename, string& directory, string& name)
+{
+    size_t slash = filename.rfind('/');
+    if (slash == string::npos) {
+        directory = ".";
+        name = filename;
+    } else {
+        directory = filename.substr(0, slash);
+        name = filename.substr(slash + 1);
+    }
+}
+
+shader_watcher::shader_watcher() :
+    m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if (m_fd < 0) {
+        fprintf(stderr, "Shader hot reload disabled: %s\n", strerror(errno));
+    }
+}
+
+shader_watcher::~shader_watcher()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void shader_watcher::watch(gl_wrapper::shader_program& program)
+{
+    for (const string& filename : program.source_files()) {
+        watch_file(filename, &program);
+    }
+}
+
+void shader_watcher::watch_file(const string& filename, gl_wrapper::shader_program *program)
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    string directory;
+    string name;
+    split_path(filename, directory, name);
+
+    // Watching a directory twice returns the same descriptor
+    int wd = inotify_add_watch(m_fd, directory.c_str(), s_watch_events);
+    if (wd < 0) {
+        fprintf(stderr, "Cannot watch %s: %s\n", directory.c_str(), strerror(errno));
+        return;
+    }
+    m_directories[wd] = directory;
+
+    vector<gl_wrapper::shader_program *>& programs = m_files[directory + "/" + name];
+    if (find(programs.begin(), programs.end(), program) == programs.end()) {
+        programs.push_back(program);
+    }
+}
+
+void shader_watcher::poll()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    m_changed.clear();
+
+    for (;;) {
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+
+        for (char *p = buffer; p < buffer + length; ) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            auto dir = m_directories.find(event->wd);
+            if (dir == m_directories.end() || event->len == 0) {
+                continue;
+            }
+
+            auto file = m_files.find(dir->second + "/" + event->name);
+            if (file == m_files.end()) {
+                continue;
+            }
+            for (gl_wrapper::shader_program *program : file->second) {
+                if (find(m_changed.begin(), m_changed.end(), program) == m_changed.end()) {
+                    m_changed.push_back(program);
+                }
+            }
+        }
+    }
+
+    // A reload may have picked up new includes
+    for (gl_wrapper::shader_program *program : m_changed) {
+        if (program->reload()) {
+            watch(*program);
+        }
+    }
+}
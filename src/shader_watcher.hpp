@@ -0,0 +1,46 @@
+#ifndef SHADER_WATCHER_HPP
+#define SHADER_WATCHER_HPP
+
+// Local Headers
+#include "gl_wrapper.hpp"
+
+// C++ Standard Headers
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ *  Reloads shader programs when their source files change on disk
+ *
+ *  Every file a program was built from is watched, includes too, using
+ *  inotify on the directories holding them.  That also
+ *  catches editors that save by writing a new file and renaming it over
+ *  the old one.  poll() never blocks and must be called on the thread
+ *  that owns the GL context; each changed program is reloaded once per
+ *  poll however many events arrived for it.  If inotify is unavailable
+ *  the watcher does nothing.
+ */
+class shader_watcher {
+ public:
+    shader_watcher();
+    ~shader_watcher();
+
+    shader_watcher(const shader_watcher&) = delete;
+    shader_watcher& operator=(const shader_watcher&) = delete;
+
+    void watch(gl_wrapper::shader_program& program);
+    void poll();
+
+ private:
+    void watch_file(const std::string& filename, gl_wrapper::shader_program *program);
+
+    int m_fd;
+
+    // Watch descriptor to directory, and "directory/name" to programs
+    std::unordered_map<int, std::string> m_directories;
+    std::unordered_map<std::string, std::vector<gl_wrapper::shader_program *>> m_files;
+
+    std::vector<gl_wrapper::shader_program *> m_changed;
+};
+
+#endif // SHADER_WATCHER_HPP
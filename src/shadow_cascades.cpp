@@ -0,0 +1,216 @@
+// Module Header
+#include "shadow_cascades.hpp"
+
+// External Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// C Standard Headers
+#include <cmath>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <algorithm>
+
+using namespace std;
+
+// Weight of the logarithmic split against the uniform one
+static const float s_split_blend = 0.75f;
+
+// Bounding sphere radii are rounded up to this, so float error in the
+// fit cannot change the texel size from frame to frame
+static const float s_radius_step = 1.0f / 16.0f;
+
+shadow_cascades::shadow_cascades(const glm::vec3& sun_direction) :
+    m_maps(map_size, cascade_count),
+    m_sun_direction(glm::normalize(sun_direction)),
+    m_camera_projection(1.0f),
+    m_near(0),
+    m_far(0),
+    m_cascades{},
+    m_amortize(true),
+    m_frame(0)
+{
+    // Only the light's orientation matters; the cascades place their own
+    // boxes in light space
+    glm::vec3 up = fabsf(m_sun_direction.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+    m_light_view = glm::lookAt(glm::vec3(0.0f), m_sun_direction, up);
+}
+
+// Recovers the near and far planes from a glm::perspective() matrix and
+// splits the range between them
+void shadow_cascades::set_projection(const glm::mat4& projection)
+{
+    m_camera_projection = projection;
+    m_near = projection[3][2] / (projection[2][2] - 1.0f);
+    m_far = projection[3][2] / (projection[2][2] + 1.0f);
+
+    float previous = m_near;
+    for (int i = 0; i < cascade_count; i++) {
+        float fraction = (i + 1) / (float)cascade_count;
+        float logarithmic = m_near * powf(m_far / m_near, fraction);
+        float uniform = m_near + (m_far - m_near) * fraction;
+
+        cascade_state& c = m_cascades[i];
+        c.near = previous;
+        c.far = s_split_blend * logarithmic + (1.0f - s_split_blend) * uniform;
+        c.valid = false;
+        previous = c.far;
+    }
+}
+
+// Refits the cascades that are due this frame and returns them as a bit
+// mask; the caller draws exactly those
+uint32_t shadow_cascades::update(const glm::mat4& view)
+{
+    if (m_far <= m_near) {
+        return 0;
+    }
+
+    // Corners of the whole view volume; the slices lie along the rays
+    // between them, with view depth linear along each ray
+    glm::mat4 inverse = glm::inverse(m_camera_projection * view);
+    static const float corner_x[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+    static const float corner_y[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+    glm::vec3 near_corners[4];
+    glm::vec3 far_corners[4];
+    for (int i = 0; i < 4; i++) {
+        glm::vec4 n = inverse * glm::vec4(corner_x[i], corner_y[i], -1.0f, 1.0f);
+        glm::vec4 f = inverse * glm::vec4(corner_x[i], corner_y[i], 1.0f, 1.0f);
+        near_corners[i] = glm::vec3(n) / n.w;
+        far_corners[i] = glm::vec3(f) / f.w;
+    }
+
+    uint32_t due = 0;
+    for (int i = 0; i < cascade_count; i++) {
+        cascade_state& c = m_cascades[i];
+        int interval = update_interval(i);
+        if (c.valid && m_frame % interval != (uint64_t)(interval / 2)) {
+            continue;
+        }
+
+        fit(c, near_corners, far_corners);
+        due |= 1u << i;
+    }
+
+    m_frame++;
+    return due;
+}
+
+void shadow_cascades::fit(cascade_state& c, const glm::vec3 near_corners[4], const glm::vec3 far_corners[4])
+{
+    float t0 = (c.near - m_near) / (m_far - m_near);
+    float t1 = (c.far - m_near) / (m_far - m_near);
+
+    glm::vec3 corners[8];
+    glm::vec3 center(0.0f);
+    for (int i = 0; i < 4; i++) {
+        corners[i] = glm::mix(near_corners[i], far_corners[i], t0);
+        corners[i + 4] = glm::mix(near_corners[i], far_corners[i], t1);
+        center += corners[i] + corners[i + 4];
+    }
+    center /= 8.0f;
+
+    float radius = 0;
+    for (const glm::vec3& corner : corners) {
+        radius = max(radius, glm::length(corner - center));
+    }
+    radius = ceilf(radius / s_radius_step) * s_radius_step;
+
+    // Whole texel steps in light space, so the map's texel grid stays
+    // fixed to the world
+    c.texel = 2.0f * radius / map_size;
+    glm::vec3 light = glm::vec3(m_light_view * glm::vec4(center, 1.0f));
+    light.x = floorf(light.x / c.texel) * c.texel;
+    light.y = floorf(light.y / c.texel) * c.texel;
+
+    c.box_min = glm::vec2(light.x - radius, light.y - radius);
+    c.box_max = glm::vec2(light.x + radius, light.y + radius);
+    c.box_back = light.z - radius;
+
+    // Looking down -z: the near plane is the side facing the sun
+    c.projection = glm::ortho(c.box_min.x, c.box_max.x,
+                              c.box_min.y, c.box_max.y,
+                              -(light.z + radius), -c.box_back);
+    c.matrix = c.projection * m_light_view;
+    c.valid = true;
+}
+
+// Whether an axis aligned box in world space (a section) can cast a
+// shadow into the cascade: it overlaps the box sideways and is not
+// entirely behind it as seen from the sun
+bool shadow_cascades::casts_into(int cascade, const glm::vec3& min, const glm::vec3& max) const
+{
+    const cascade_state& c = m_cascades[cascade];
+
+    glm::vec3 half = (max - min) * 0.5f;
+    glm::vec3 center = glm::vec3(m_light_view * glm::vec4(min + half, 1.0f));
+    glm::mat3 rotation(m_light_view);
+    glm::vec3 extent = glm::abs(rotation[0]) * half.x +
+                       glm::abs(rotation[1]) * half.y +
+                       glm::abs(rotation[2]) * half.z;
+
+    return center.x + extent.x >= c.box_min.x && center.x - extent.x <= c.box_max.x &&
+           center.y + extent.y >= c.box_min.y && center.y - extent.y <= c.box_max.y &&
+           center.z + extent.z >= c.box_back;
+}
+
+// Makes the cascade's layer the render target and clears it
+void shadow_cascades::bind_target(int cascade)
+{
+    m_maps.bind_layer(cascade);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void shadow_cascades::bind_texture()
+{
+    m_maps.bind();
+}
+
+const glm::vec3& shadow_cascades::sun_direction() const
+{
+    return m_sun_direction;
+}
+
+const glm::mat4& shadow_cascades::light_view() const
+{
+    return m_light_view;
+}
+
+const glm::mat4& shadow_cascades::projection(int cascade) const
+{
+    return m_cascades[cascade].projection;
+}
+
+const glm::mat4& shadow_cascades::matrix(int cascade) const
+{
+    return m_cascades[cascade].matrix;
+}
+
+float shadow_cascades::split(int cascade) const
+{
+    return m_cascades[cascade].far;
+}
+
+float shadow_cascades::texel_size(int cascade) const
+{
+    return m_cascades[cascade].texel;
+}
+
+void shadow_cascades::set_amortize(bool enabled)
+{
+    m_amortize = enabled;
+}
+
+bool shadow_cascades::amortize() const
+{
+    return m_amortize;
+}
+
+// Cascade i is redrawn every 2^i frames, on frames where frame % 2^i is
+// 2^(i-1), so no two of the amortized cascades fall on the same frame
+int shadow_cascades::update_interval(int cascade) const
+{
+    return m_amortize ? 1 << cascade : 1;
+}
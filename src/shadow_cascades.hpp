@@ -0,0 +1,89 @@
+#ifndef SHADOW_CASCADES_HPP
+#define SHADOW_CASCADES_HPP
+
+// Local Headers
+#include "gl_wrapper.hpp"
+
+// External Headers
+#include <glm/glm.hpp>
+
+// C Standard Headers
+#include <cstdint>
+
+/**
+ *  Cascaded shadow maps for the sun
+ *
+ *  The camera's view range is split into cascade_count slices, spaced
+ *  between logarithmic and uniform so the near slices are short, and
+ *  each slice gets its own layer of a depth texture array.  A cascade is
+ *  an orthographic box along the sun direction around the bounding
+ *  sphere of its slice.  The sphere's size does not change as the camera
+ *  turns, and its centre is snapped to whole shadow texels, so shadow
+ *  edges stay put instead of shimmering as the camera moves.  Casters
+ *  between the sun and the box are drawn with depth clamping, so the box
+ *  only has to reach as far towards the sun as the slice itself.
+ *
+ *  The far cascades cover the most ground at the least detail and change
+ *  the least from frame to frame, so with amortizing on they are redrawn
+ *  every update_interval(i) frames, staggered so that no frame draws
+ *  more than two cascades.  A cascade keeps the matrix it was drawn
+ *  with, so the shader stays consistent with a stale map; where the
+ *  camera has moved past what a stale cascade covers, the shader falls
+ *  through to the next cascade, or to unshadowed beyond the last.
+ */
+class shadow_cascades {
+ public:
+    static const int cascade_count = 3;
+    static const int map_size = 1024;
+
+    explicit shadow_cascades(const glm::vec3& sun_direction);
+
+    void set_projection(const glm::mat4& projection);
+    uint32_t update(const glm::mat4& view);
+
+    bool casts_into(int cascade, const glm::vec3& min, const glm::vec3& max) const;
+    void bind_target(int cascade);
+    void bind_texture();
+
+    const glm::vec3& sun_direction() const;
+    const glm::mat4& light_view() const;
+    const glm::mat4& projection(int cascade) const;
+    const glm::mat4& matrix(int cascade) const;
+    float split(int cascade) const;
+    float texel_size(int cascade) const;
+
+    void set_amortize(bool enabled);
+    bool amortize() const;
+    int update_interval(int cascade) const;
+
+ private:
+    struct cascade_state {
+        float near;
+        float far;
+        bool valid;
+
+        // Box in light view space: x and y bounds, and how far back it
+        // reaches along the light; it is open towards the sun
+        glm::vec2 box_min;
+        glm::vec2 box_max;
+        float box_back;
+        float texel;
+
+        glm::mat4 projection;
+        glm::mat4 matrix;
+    };
+
+    void fit(cascade_state& c, const glm::vec3 near_corners[4], const glm::vec3 far_corners[4]);
+
+    gl_wrapper::depth_texture_array m_maps;
+    glm::vec3 m_sun_direction;
+    glm::mat4 m_light_view;
+    glm::mat4 m_camera_projection;
+    float m_near;
+    float m_far;
+    cascade_state m_cascades[cascade_count];
+    bool m_amortize;
+    uint64_t m_frame;
+};
+
+#endif // SHADOW_CASCADES_HPP
@@ -0,0 +1,244 @@
+// Module Header
+#include "simulation.hpp"
+
+// Local Headers
+#include "edit_batch.hpp"
+#include "raycast.hpp"
+#include "trace.hpp"
+
+// External Headers
+#include <SDL2/SDL.h>
+
+// C Standard Headers
+#include <cmath>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static const float s_reach = 8.0f;
+static const float s_blast_distance = 8.0f;
+static const int s_blast_radius = 5;
+
+// Longest frame fed into the accumulator; past this the simulation
+// slows down instead of spiralling into ever more catch-up ticks.
+static const float s_max_frame_seconds = 0.25f;
+
+simulation::simulation(world& w,
+                       light_engine& lighting,
+                       chunk_io& io,
+                       worker_pool& pool,
+                       camera& cam,
+                       float tick_seconds) :
+    m_world(w),
+    m_lighting(lighting),
+    m_io(io),
+    m_pool(pool),
+    m_camera(cam),
+    m_tick_seconds(tick_seconds),
+    m_input(),
+    m_accumulator(0),
+    m_ticks(0),
+    m_last_tick(clock::now()),
+    m_running(false)
+{
+}
+
+simulation::~simulation()
+{
+    stop_thread();
+}
+
+void simulation::set_input(const camera_input& input)
+{
+    lock_guard<mutex> lock(m_input_mutex);
+    m_input = input;
+}
+
+void simulation::blast()
+{
+    queue_action(action::blast);
+}
+
+// Left click breaks the block under the crosshair, right click places
+// a crate against the face that was hit and middle click a lamp.  Other
+// buttons do nothing.
+void simulation::pick(uint8_t button)
+{
+    if (button == SDL_BUTTON_LEFT) {
+        queue_action(action::break_block);
+    } else if (button == SDL_BUTTON_MIDDLE) {
+        queue_action(action::place_lamp);
+    } else if (button == SDL_BUTTON_RIGHT) {
+        queue_action(action::place_crate);
+    }
+}
+
+void simulation::advance(float frame_seconds)
+{
+    m_accumulator += min(frame_seconds, s_max_frame_seconds);
+    while (m_accumulator >= m_tick_seconds) {
+        lock_guard<mutex> lock(m_world_mutex);
+        tick();
+        m_accumulator -= m_tick_seconds;
+    }
+}
+
+void simulation::start_thread()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = thread(&simulation::thread_main, this);
+}
+
+void simulation::stop_thread()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    m_thread.join();
+}
+
+mutex& simulation::world_mutex()
+{
+    return m_world_mutex;
+}
+
+glm::mat4 simulation::view()
+{
+    lock_guard<mutex> lock(m_world_mutex);
+    return m_camera.view(alpha());
+}
+
+uint64_t simulation::tick_count() const
+{
+    return m_ticks;
+}
+
+void simulation::queue_action(action a)
+{
+    lock_guard<mutex> lock(m_input_mutex);
+    m_actions.push_back(a);
+}
+
+void simulation::tick()
+{
+    TRACE_SCOPE("tick");
+    camera_input input;
+    m_tick_actions.clear();
+    {
+        lock_guard<mutex> lock(m_input_mutex);
+        input = m_input;
+        swap(m_tick_actions, m_actions);
+    }
+
+    for (action a : m_tick_actions) {
+        if (a == action::blast) {
+            do_blast();
+        } else {
+            do_pick(a);
+        }
+    }
+
+    m_camera.update(input, m_tick_seconds);
+
+    m_loaded.clear();
+    m_failed_saves.clear();
+    m_io.poll(m_loaded, m_failed_saves);
+    for (const chunk_coord& coord : m_failed_saves) {
+        chunk *c = m_world.find_chunk(coord);
+        if (c) {
+            c->mark_unsaved();
+        }
+    }
+    {
+        TRACE_SCOPE("insert chunks");
+        for (chunk_io::loaded_chunk& l : m_loaded) {
+            if (l.data) {
+                m_world.insert_chunk(l.coord, move(l.data));
+            }
+        }
+    }
+
+    m_lighting.update(m_pool);
+
+    m_ticks++;
+    m_last_tick = clock::now();
+}
+
+void simulation::thread_main()
+{
+    TRACE_THREAD_NAME("simulation");
+    clock::time_point last = clock::now();
+    float accumulator = 0;
+
+    while (m_running) {
+        clock::time_point now = clock::now();
+        chrono::duration<float> elapsed = now - last;
+        last = now;
+
+        accumulator += min(elapsed.count(), s_max_frame_seconds);
+        while (accumulator >= m_tick_seconds) {
+            lock_guard<mutex> lock(m_world_mutex);
+            tick();
+            accumulator -= m_tick_seconds;
+        }
+
+        chrono::duration<float> wait(m_tick_seconds - accumulator);
+        this_thread::sleep_for(wait);
+    }
+}
+
+// How far the present is between the last tick and the next one
+float simulation::alpha() const
+{
+    float a;
+    if (m_running) {
+        chrono::duration<float> since = clock::now() - m_last_tick;
+        a = since.count() / m_tick_seconds;
+    } else {
+        a = m_accumulator / m_tick_seconds;
+    }
+
+    return min(max(a, 0.0f), 1.0f);
+}
+
+void simulation::do_blast()
+{
+    glm::vec3 center = m_camera.position() + m_camera.front() * s_blast_distance;
+
+    edit_batch batch;
+    batch.sphere((int)floorf(center.x), (int)floorf(center.y), (int)floorf(center.z),
+                 s_blast_radius, block::air);
+    batch.commit(m_world, m_pool);
+}
+
+void simulation::do_pick(action a)
+{
+    raycast_hit hit;
+    if (!raycast(m_world, m_camera.position(), m_camera.front(), s_reach, hit)) {
+        return;
+    }
+
+    if (a == action::break_block) {
+        m_world.set_block(hit.position[0], hit.position[1], hit.position[2], block::air);
+        return;
+    }
+
+    const int *n = face_offsets[static_cast<int>(hit.normal_face)];
+    m_world.set_block(hit.position[0] + n[0],
+                      hit.position[1] + n[1],
+                      hit.position[2] + n[2],
+                      a == action::place_lamp ? block::lamp : block::crate);
+}
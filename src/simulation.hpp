@@ -0,0 +1,108 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+// Local Headers
+#include "camera.hpp"
+#include "chunk_io.hpp"
+#include "lighting.hpp"
+#include "world.hpp"
+#include "worker_pool.hpp"
+
+// External Headers
+#include <glm/glm.hpp>
+
+// C Standard Headers
+#include <cstdint>
+
+// C++ Standard Headers
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  Everything that advances game state, run at a fixed tick rate
+ *
+ *  Each tick applies queued player actions, moves the camera, takes in
+ *  chunks the I/O threads have loaded and updates lighting.  Frame time
+ *  is fed into an accumulator and consumed in whole ticks, so the
+ *  simulation behaves the same at any frame rate; view() interpolates
+ *  the camera between the last two ticks for smooth rendering.
+ *
+ *  Ticks run either from advance() on the render thread or, after
+ *  start_thread(), on a thread of their own so a slow tick does not
+ *  stall a frame.  Either way they hold world_mutex(), which the
+ *  renderer must also hold while it reads the world.
+ */
+class simulation {
+ public:
+    simulation(world& w,
+               light_engine& lighting,
+               chunk_io& io,
+               worker_pool& pool,
+               camera& cam,
+               float tick_seconds);
+    ~simulation();
+
+    simulation(const simulation&) = delete;
+    simulation& operator=(const simulation&) = delete;
+
+    void set_input(const camera_input& input);
+    void blast();
+    void pick(uint8_t button);
+
+    void advance(float frame_seconds);
+
+    void start_thread();
+    void stop_thread();
+
+    std::mutex& world_mutex();
+    glm::mat4 view();
+    uint64_t tick_count() const;
+
+ private:
+    typedef std::chrono::steady_clock clock;
+
+    enum class action : uint8_t {
+        blast,
+        break_block,
+        place_crate,
+        place_lamp
+    };
+
+    void queue_action(action a);
+    void tick();
+    void thread_main();
+    float alpha() const;
+
+    void do_blast();
+    void do_pick(action a);
+
+    world& m_world;
+    light_engine& m_lighting;
+    chunk_io& m_io;
+    worker_pool& m_pool;
+    camera& m_camera;
+    float m_tick_seconds;
+
+    std::mutex m_world_mutex;
+
+    // Written by the render thread, consumed by ticks
+    std::mutex m_input_mutex;
+    camera_input m_input;
+    std::vector<action> m_actions;
+    std::vector<action> m_tick_actions;
+
+    std::vector<chunk_io::loaded_chunk> m_loaded;
+    std::vector<chunk_coord> m_failed_saves;
+
+    float m_accumulator;
+    std::atomic<uint64_t> m_ticks;
+    clock::time_point m_last_tick;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+};
+
+#endif // SIMULATION_HPP
@@ -0,0 +1,336 @@
+// Module Header
+#include "stats_overlay.hpp"
+
+// External Headers
+#include <glad/glad.h>
+
+// C Standard Headers
+#include <cstdarg>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 5x7 glyphs for ASCII 32 to 126, one byte per column, top row in bit 0
+static const uint8_t s_glyphs[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5f, 0x00, 0x00}, // ' ' !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7f, 0x14, 0x7f, 0x14}, // " #
+    {0x24, 0x2a, 0x7f, 0x2a, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // $ %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, // & '
+    {0x00, 0x1c, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1c, 0x00}, // ( )
+    {0x14, 0x08, 0x3e, 0x08, 0x14}, {0x08, 0x08, 0x3e, 0x08, 0x08}, // * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, // , -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02}, // . /
+    {0x3e, 0x51, 0x49, 0x45, 0x3e}, {0x00, 0x42, 0x7f, 0x40, 0x00}, // 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4b, 0x31}, // 2 3
+    {0x18, 0x14, 0x12, 0x7f, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, // 4 5
+    {0x3c, 0x4a, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1e}, // 8 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00}, // : ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, // > ?
+    {0x32, 0x49, 0x79, 0x41, 0x3e}, {0x7e, 0x11, 0x11, 0x11, 0x7e}, // @ A
+    {0x7f, 0x49, 0x49, 0x49, 0x36}, {0x3e, 0x41, 0x41, 0x41, 0x22}, // B C
+    {0x7f, 0x41, 0x41, 0x22, 0x1c}, {0x7f, 0x49, 0x49, 0x49, 0x41}, // D E
+    {0x7f, 0x09, 0x09, 0x09, 0x01}, {0x3e, 0x41, 0x49, 0x49, 0x7a}, // F G
+    {0x7f, 0x08, 0x08, 0x08, 0x7f}, {0x00, 0x41, 0x7f, 0x41, 0x00}, // H I
+    {0x20, 0x40, 0x41, 0x3f, 0x01}, {0x7f, 0x08, 0x14, 0x22, 0x41}, // J K
+    {0x7f, 0x40, 0x40, 0x40, 0x40}, {0x7f, 0x02, 0x0c, 0x02, 0x7f}, // L M
+    {0x7f, 0x04, 0x08, 0x10, 0x7f}, {0x3e, 0x41, 0x41, 0x41, 0x3e}, // N O
+    {0x7f, 0x09, 0x09, 0x09, 0x06}, {0x3e, 0x41, 0x51, 0x21, 0x5e}, // P Q
+    {0x7f, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31}, // R S
+    {0x01, 0x01, 0x7f, 0x01, 0x01}, {0x3f, 0x40, 0x40, 0x40, 0x3f}, // T U
+    {0x1f, 0x20, 0x40, 0x20, 0x1f}, {0x3f, 0x40, 0x38, 0x40, 0x3f}, // V W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, // X Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7f, 0x41, 0x41, 0x00}, // Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7f, 0x00}, // \ ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40}, // ^ _
+    {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // ` a
+    {0x7f, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, // b c
+    {0x38, 0x44, 0x44, 0x48, 0x7f}, {0x38, 0x54, 0x54, 0x54, 0x18}, // d e
+    {0x08, 0x7e, 0x09, 0x01, 0x02}, {0x0c, 0x52, 0x52, 0x52, 0x3e}, // f g
+    {0x7f, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7d, 0x40, 0x00}, // h i
+    {0x20, 0x40, 0x44, 0x3d, 0x00}, {0x7f, 0x10, 0x28, 0x44, 0x00}, // j k
+    {0x00, 0x41, 0x7f, 0x40, 0x00}, {0x7c, 0x04, 0x18, 0x04, 0x78}, // l m
+    {0x7c, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, // n o
+    {0x7c, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7c}, // p q
+    {0x7c, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // r s
+    {0x04, 0x3f, 0x44, 0x40, 0x20}, {0x3c, 0x40, 0x40, 0x20, 0x7c}, // t u
+    {0x1c, 0x20, 0x40, 0x20, 0x1c}, {0x3c, 0x40, 0x30, 0x40, 0x3c}, // v w
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0c, 0x50, 0x50, 0x50, 0x3c}, // x y
+    {0x44, 0x64, 0x54, 0x4c, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, // z {
+    {0x00, 0x00, 0x7f, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, // | }
+    {0x08, 0x04, 0x08, 0x10, 0x08}                                  // ~
+};
+
+// Atlas of 6x8 cells (glyph plus spacing) for characters 32 to 127.
+// Cell 127 is solid and serves the panel and graph quads.
+static const int s_first_char = 32;
+static const int s_cell_count = 96;
+static const int s_solid_cell = 127 - s_first_char;
+static const int s_cell_width = 6;
+static const int s_cell_height = 8;
+static const int s_atlas_columns = 16;
+static const int s_atlas_width = s_atlas_columns * s_cell_width;
+static const int s_atlas_height = (s_cell_count / s_atlas_columns) * s_cell_height;
+
+// Screen pixels per font pixel, and layout in screen pixels
+static const float s_scale = 2.0f;
+static const float s_margin = 8.0f;
+static const float s_padding = 6.0f;
+static const float s_graph_height = 64.0f;
+static const float s_graph_bar_width = 2.0f;
+
+// The top of the graph is 33 ms (30 fps) and a line marks 16.7 ms
+static const float s_graph_max_seconds = 1.0f / 30.0f;
+static const float s_graph_target_seconds = 1.0f / 60.0f;
+
+static const float s_text_color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+static const float s_panel_color[4] = {0.0f, 0.0f, 0.0f, 0.6f};
+static const float s_target_color[4] = {1.0f, 1.0f, 1.0f, 0.5f};
+static const float s_fast_color[4] = {0.3f, 0.9f, 0.3f, 0.9f};
+static const float s_slow_color[4] = {0.9f, 0.8f, 0.2f, 0.9f};
+static const float s_late_color[4] = {0.9f, 0.2f, 0.2f, 0.9f};
+
+static vector<uint8_t> build_atlas()
+{
+    vector<uint8_t> pixels(s_atlas_width * s_atlas_height, 0);
+
+    for (int cell = 0; cell < s_cell_count; cell++) {
+        int left = (cell % s_atlas_columns) * s_cell_width;
+        int top = (cell / s_atlas_columns) * s_cell_height;
+
+        for (int y = 0; y < s_cell_height; y++) {
+            for (int x = 0; x < s_cell_width; x++) {
+                bool lit;
+                if (cell == s_solid_cell) {
+                    lit = true;
+                } else {
+                    lit = x < 5 && y < 7 && (s_glyphs[cell][x] >> y) & 1;
+                }
+                pixels[(top + y) * s_atlas_width + left + x] = lit ? 0xff : 0;
+            }
+        }
+    }
+
+    return pixels;
+}
+
+static void cell_uv(int cell, float& u0, float& v0, float& u1, float& v1)
+{
+    u0 = (float)((cell % s_atlas_columns) * s_cell_width) / s_atlas_width;
+    v0 = (float)((cell / s_atlas_columns) * s_cell_height) / s_atlas_height;
+    u1 = u0 + (float)s_cell_width / s_atlas_width;
+    v1 = v0 + (float)s_cell_height / s_atlas_height;
+}
+
+stats_overlay::stats_overlay() :
+    m_shader_program(m_vertex_shader_filename, m_fragment_shader_filename),
+    m_font(s_atlas_width, s_atlas_height, build_atlas().data()),
+    m_visible(false),
+    m_screen_width(1),
+    m_screen_height(1),
+    m_next_frame(0),
+    m_line_count(0),
+    m_line_width(0)
+{
+    fill(begin(m_frames), end(m_frames), 0.0f);
+
+    m_shader_program.use();
+    m_shader_program.set_uniformi("font", 0);
+
+    GLsizei stride = vertex_floats * sizeof(float);
+    m_vao.bind();
+    m_vbo.bind();
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+void stats_overlay::toggle()
+{
+    m_visible = !m_visible;
+}
+
+bool stats_overlay::visible() const
+{
+    return m_visible;
+}
+
+void stats_overlay::set_screen_size(int width, int height)
+{
+    m_screen_width = max(width, 1);
+    m_screen_height = max(height, 1);
+}
+
+void stats_overlay::record_frame(float seconds)
+{
+    m_frames[m_next_frame] = seconds;
+    m_next_frame = (m_next_frame + 1) % graph_samples;
+}
+
+float stats_overlay::average_frame() const
+{
+    float total = 0;
+    int count = 0;
+    for (float seconds : m_frames) {
+        if (seconds > 0) {
+            total += seconds;
+            count++;
+        }
+    }
+
+    return count > 0 ? total / count : 0.0f;
+}
+
+gl_wrapper::shader_program& stats_overlay::program()
+{
+    return m_shader_program;
+}
+
+void stats_overlay::print(const char *format, ...)
+{
+    if (!m_visible) {
+        return;
+    }
+
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    float cell_w = s_cell_width * s_scale;
+    float cell_h = s_cell_height * s_scale;
+    float x = s_margin + s_padding;
+    float y = s_margin + s_padding + m_line_count * cell_h;
+
+    size_t length = 0;
+    for (const char *c = line; *c != '\0'; c++, length++) {
+        int cell = (unsigned char)*c - s_first_char;
+        if (cell <= 0 || cell >= s_solid_cell) {
+            continue;
+        }
+
+        float u0, v0, u1, v1;
+        cell_uv(cell, u0, v0, u1, v1);
+        float left = x + length * cell_w;
+        add_quad(left, y, left + cell_w, y + cell_h, u0, v0, u1, v1, s_text_color, m_text);
+    }
+
+    m_line_count++;
+    m_line_width = max(m_line_width, length);
+}
+
+void stats_overlay::draw()
+{
+    if (!m_visible) {
+        return;
+    }
+
+    float cell_h = s_cell_height * s_scale;
+    float text_width = m_line_width * s_cell_width * s_scale;
+    float graph_width = graph_samples * s_graph_bar_width;
+    float graph_top = s_margin + s_padding + m_line_count * cell_h + s_padding;
+
+    float right = s_margin + 2 * s_padding + max(text_width, graph_width);
+    float bottom = graph_top + s_graph_height + s_padding;
+
+    // Back to front: panel, graph, then text
+    m_vertices.clear();
+    add_solid(s_margin, s_margin, right, bottom, s_panel_color, m_vertices);
+    add_graph(s_margin + s_padding, graph_top);
+    m_vertices.insert(m_vertices.end(), m_text.begin(), m_text.end());
+
+    m_text.clear();
+    m_line_count = 0;
+    m_line_width = 0;
+
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_shader_program.use();
+    m_shader_program.set_uniform2f("screen_size", (float)m_screen_width, (float)m_screen_height);
+    glActiveTexture(GL_TEXTURE0);
+    m_font.bind();
+
+    m_vao.bind();
+    // Rebuilt every frame
+    m_vbo.load(m_vertices.data(), m_vertices.size() * sizeof(float), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, m_vertices.size() / vertex_floats);
+
+    if (depth_test) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+}
+
+void stats_overlay::add_quad(float x0, float y0, float x1, float y1,
+                             float u0, float v0, float u1, float v1,
+                             const float color[4],
+                             vector<float>& out)
+{
+    const float corners[6][4] = {
+        {x0, y0, u0, v0}, {x0, y1, u0, v1}, {x1, y1, u1, v1},
+        {x1, y1, u1, v1}, {x1, y0, u1, v0}, {x0, y0, u0, v0}
+    };
+
+    for (const float *c : corners) {
+        out.insert(out.end(), c, c + 4);
+        out.insert(out.end(), color, color + 4);
+    }
+}
+
+void stats_overlay::add_solid(float x0, float y0, float x1, float y1,
+                              const float color[4],
+                              vector<float>& out)
+{
+    // Sample the middle of the solid cell so filtering never reaches a
+    // neighbor
+    float u0, v0, u1, v1;
+    cell_uv(s_solid_cell, u0, v0, u1, v1);
+    float u = (u0 + u1) / 2;
+    float v = (v0 + v1) / 2;
+
+    add_quad(x0, y0, x1, y1, u, v, u, v, color, out);
+}
+
+void stats_overlay::add_graph(float x, float y)
+{
+    float bottom = y + s_graph_height;
+
+    // Oldest sample on the left
+    for (int i = 0; i < graph_samples; i++) {
+        float seconds = m_frames[(m_next_frame + i) % graph_samples];
+        float height = min(seconds / s_graph_max_seconds, 1.0f) * s_graph_height;
+
+        const float *color = s_fast_color;
+        if (seconds > s_graph_max_seconds) {
+            color = s_late_color;
+        } else if (seconds > s_graph_target_seconds) {
+            color = s_slow_color;
+        }
+
+        float left = x + i * s_graph_bar_width;
+        add_solid(left, bottom - height, left + s_graph_bar_width, bottom, color, m_vertices);
+    }
+
+    float target = bottom - (s_graph_target_seconds / s_graph_max_seconds) * s_graph_height;
+    float right = x + graph_samples * s_graph_bar_width;
+    add_solid(x, target, right, target + 1.0f, s_target_color, m_vertices);
+}
+
+const string stats_overlay::m_vertex_shader_filename = "overlay_vert.glsl";
+const string stats_overlay::m_fragment_shader_filename = "overlay_frag.glsl";
@@ -0,0 +1,83 @@
+#ifndef STATS_OVERLAY_HPP
+#define STATS_OVERLAY_HPP
+
+// Local Headers
+#include "gl_wrapper.hpp"
+
+// C Standard Headers
+#include <cstddef>
+#include <cstdint>
+
+// C++ Standard Headers
+#include <string>
+#include <vector>
+
+/**
+ *  On-screen text and frame time graph drawn over the scene
+ *
+ *  Text comes from a 5x7 bitmap font built into a small texture at
+ *  startup.  Every line, the graph and the background panel are quads
+ *  in one vertex buffer, so the whole overlay is a single draw call.
+ *
+ *  record_frame() should be called every frame so the graph is complete
+ *  when the overlay is shown; it is only a store into a ring.  While the
+ *  overlay is hidden print() and draw() return at once.
+ */
+class stats_overlay {
+ public:
+    stats_overlay();
+
+    stats_overlay(const stats_overlay&) = delete;
+    stats_overlay& operator=(const stats_overlay&) = delete;
+
+    void toggle();
+    bool visible() const;
+
+    void set_screen_size(int width, int height);
+    void record_frame(float seconds);
+
+    // Average frame time over the graph, in seconds
+    float average_frame() const;
+
+    gl_wrapper::shader_program& program();
+
+    void print(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    void draw();
+
+ private:
+    static const int graph_samples = 120;
+    static const int vertex_floats = 8;
+
+    void add_quad(float x0, float y0, float x1, float y1,
+                  float u0, float v0, float u1, float v1,
+                  const float color[4],
+                  std::vector<float>& out);
+    void add_solid(float x0, float y0, float x1, float y1,
+                   const float color[4],
+                   std::vector<float>& out);
+    void add_graph(float x, float y);
+
+    gl_wrapper::shader_program m_shader_program;
+    gl_wrapper::mask_texture m_font;
+    gl_wrapper::vao m_vao;
+    gl_wrapper::vbo m_vbo;
+
+    bool m_visible;
+    int m_screen_width;
+    int m_screen_height;
+
+    float m_frames[graph_samples];
+    int m_next_frame;
+    int m_line_count;
+    size_t m_line_width;
+
+    // Text is collected separately so the panel can be sized to fit and
+    // drawn underneath it
+    std::vector<float> m_text;
+    std::vector<float> m_vertices;
+
+    static const std::string m_vertex_shader_filename;
+    static const std::string m_fragment_shader_filename;
+};
+
+#endif // STATS_OVERLAY_HPP
@@ -0,0 +1,157 @@
+// Module Header
+#include "trace.hpp"
+
+// C Standard Headers
+#include <cstdio>
+
+// C++ Standard Headers
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace trace {
+
+// Events per thread before recording stops, 24 bytes each
+static const size_t s_buffer_events = 1 << 18;
+
+struct event {
+    const char *name;
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+// Written only by its thread; `count` publishes finished events to the
+// exporter.  Buffers live until exit so the exporter can read buffers of
+// threads that have finished.
+struct thread_buffer {
+    explicit thread_buffer(int tid) :
+        tid(tid),
+        name(nullptr),
+        events(new event[s_buffer_events]),
+        count(0),
+        dropped(0)
+    {
+    }
+
+    int tid;
+    atomic<const char *> name;
+    unique_ptr<event[]> events;
+    atomic<size_t> count;
+    atomic<size_t> dropped;
+};
+
+static atomic<bool> s_enabled(false);
+
+static mutex s_buffers_mutex;
+static vector<unique_ptr<thread_buffer>> s_buffers;
+
+static thread_local thread_buffer *s_thread_buffer = nullptr;
+
+// Kept apart from the buffer, so naming a thread that never records
+// costs no buffer
+static thread_local const char *s_thread_name = nullptr;
+
+static thread_buffer& this_thread_buffer()
+{
+    if (s_thread_buffer == nullptr) {
+        lock_guard<mutex> lock(s_buffers_mutex);
+        s_buffers.push_back(make_unique<thread_buffer>((int)s_buffers.size() + 1));
+        s_thread_buffer = s_buffers.back().get();
+        s_thread_buffer->name.store(s_thread_name, memory_order_release);
+    }
+
+    return *s_thread_buffer;
+}
+
+int64_t now_ns()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void set_enabled(bool enabled)
+{
+    s_enabled.store(enabled, memory_order_relaxed);
+}
+
+bool enabled()
+{
+    return s_enabled.load(memory_order_relaxed);
+}
+
+void record(const char *name, int64_t start_ns, int64_t end_ns)
+{
+    thread_buffer& b = this_thread_buffer();
+
+    size_t n = b.count.load(memory_order_relaxed);
+    if (n == s_buffer_events) {
+        b.dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    b.events[n] = event{name, start_ns, end_ns};
+    b.count.store(n + 1, memory_order_release);
+}
+
+void set_thread_name(const char *name)
+{
+    s_thread_name = name;
+    if (s_thread_buffer != nullptr) {
+        s_thread_buffer->name.store(name, memory_order_release);
+    }
+}
+
+bool write_chrome_trace(const string& filename,
+                        const function<void(FILE *)>& extra_events)
+{
+    FILE *out = fopen(filename.c_str(), "w");
+    if (out == nullptr) {
+        return false;
+    }
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"args\":{\"name\":\"voxel\"}}");
+
+    size_t dropped = 0;
+    {
+        lock_guard<mutex> lock(s_buffers_mutex);
+        for (const unique_ptr<thread_buffer>& b : s_buffers) {
+            const char *name = b->name.load(memory_order_acquire);
+            string label = name ? name : "thread " + to_string(b->tid);
+            fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                         "\"args\":{\"name\":\"%s\"}}", b->tid, label.c_str());
+
+            size_t count = b->count.load(memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const event& e = b->events[i];
+                fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                             "\"ts\":%.3f,\"dur\":%.3f}",
+                        e.name, b->tid,
+                        e.start_ns / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+            }
+            dropped += b->dropped.load(memory_order_relaxed);
+        }
+    }
+
+    if (extra_events) {
+        extra_events(out);
+    }
+    fprintf(out, "\n]}\n");
+
+    bool ok = ferror(out) == 0;
+    fclose(out);
+
+    if (dropped > 0) {
+        fprintf(stderr, "trace: %zu events dropped, buffers full\n", dropped);
+    }
+    return ok;
+}
+
+} // namespace trace
@@ -0,0 +1,77 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// C Standard Headers
+#include <cstdint>
+#include <cstdio>
+
+// C++ Standard Headers
+#include <functional>
+#include <string>
+
+/**
+ *  Low overhead CPU tracing of named scopes, exported as Chrome trace
+ *  JSON (which Perfetto also loads)
+ *
+ *  Use the macros rather than the namespace directly: TRACE_SCOPE("name")
+ *  times the rest of the enclosing block and TRACE_THREAD_NAME("name")
+ *  labels the calling thread's track.  Names must be string literals.
+ *  Without VOXEL_TRACE defined the macros compile to nothing.
+ *
+ *  Each thread records into its own fixed size buffer, which only that
+ *  thread writes, so recording takes no locks; a full buffer drops
+ *  further events.  Nothing is recorded until trace::set_enabled(true).
+ */
+namespace trace {
+
+int64_t now_ns();
+
+void set_enabled(bool enabled);
+bool enabled();
+
+void record(const char *name, int64_t start_ns, int64_t end_ns);
+void set_thread_name(const char *name);
+
+bool write_chrome_trace(const std::string& filename,
+                        const std::function<void(FILE *)>& extra_events = nullptr);
+
+class scope {
+ public:
+    explicit scope(const char *name);
+    ~scope();
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+ private:
+    const char *m_name;
+    int64_t m_start_ns;
+};
+
+inline scope::scope(const char *name) :
+    m_name(name),
+    m_start_ns(enabled() ? now_ns() : 0)
+{
+}
+
+inline scope::~scope()
+{
+    if (m_start_ns != 0) {
+        record(m_name, m_start_ns, now_ns());
+    }
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef VOXEL_TRACE
+#define TRACE_SCOPE(name) trace::scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) trace::set_thread_name(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+#endif // TRACE_HPP
@@ -0,0 +1,112 @@
+// Module Header
+#include "worker_pool.hpp"
+
+// Local Headers
+#include "trace.hpp"
+
+using namespace std;
+
+worker_pool::worker_pool(int thread_count) :
+    m_job(nullptr),
+    m_count(0),
+    m_next(0),
+    m_active(0),
+    m_generation(0),
+    m_quit(false)
+{
+    for (int i = 0; i < thread_count; i++) {
+        m_threads.emplace_back(&worker_pool::worker_main, this);
+    }
+}
+
+worker_pool::~worker_pool()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_start_cv.notify_all();
+
+    for (thread& t : m_threads) {
+        t.join();
+    }
+}
+
+void worker_pool::parallel_for(size_t count, const function<void(size_t)>& job)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Not worth waking anyone for a single job
+    if (count == 1 || m_threads.empty()) {
+        for (size_t i = 0; i < count; i++) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next = 0;
+        m_active = m_threads.size();
+        m_generation++;
+    }
+    m_start_cv.notify_all();
+
+    run_jobs();
+
+    unique_lock<mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [this] { return m_active == 0; });
+    m_job = nullptr;
+}
+
+int worker_pool::thread_count() const
+{
+    return m_threads.size();
+}
+
+int worker_pool::default_thread_count()
+{
+    // Leave one hardware thread for the caller
+    int hw = thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 0;
+}
+
+void worker_pool::worker_main()
+{
+    TRACE_THREAD_NAME("worker");
+    unsigned seen = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_start_cv.wait(lock, [&] { return m_quit || m_generation != seen; });
+            if (m_quit) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        run_jobs();
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_active--;
+        }
+        m_done_cv.notify_one();
+    }
+}
+
+void worker_pool::run_jobs()
+{
+    while (true) {
+        size_t i = m_next.fetch_add(1);
+        if (i >= m_count) {
+            return;
+        }
+        (*m_job)(i);
+    }
+}
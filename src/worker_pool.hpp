@@ -0,0 +1,54 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+// C Standard Headers
+#include <cstddef>
+
+// C++ Standard Headers
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  Fixed set of threads for data-parallel loops over independent jobs
+ *
+ *  parallel_for() hands out job indices from a shared counter and blocks
+ *  until every job has run; the calling thread works too, so a pool of
+ *  N threads gives N + 1 way parallelism and a pool of zero threads
+ *  degrades to a plain loop.  Only one thread may call parallel_for()
+ *  at a time.
+ */
+class worker_pool {
+ public:
+    explicit worker_pool(int thread_count = default_thread_count());
+    ~worker_pool();
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    void parallel_for(size_t count, const std::function<void(size_t)>& job);
+
+    int thread_count() const;
+    static int default_thread_count();
+
+ private:
+    void worker_main();
+    void run_jobs();
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start_cv;
+    std::condition_variable m_done_cv;
+    const std::function<void(size_t)> *m_job;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+    int m_active;
+    unsigned m_generation;
+    bool m_quit;
+};
+
+#endif // WORKER_POOL_HPP
@@ -0,0 +1,257 @@
+// Module Header
+#include "world.hpp"
+
+// C++ Standard Headers
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+world::world() :
+    m_change_log(false)
+{
+}
+
+block world::get_block(int x, int y, int z) const
+{
+    const chunk *c = find_chunk(chunk_of(x, y, z));
+    if (c == nullptr) {
+        return block::air;
+    }
+
+    return c->get(floor_mod(x, chunk::size),
+                  floor_mod(y, chunk::size),
+                  floor_mod(z, chunk::size));
+}
+
+void world::set_block(int x, int y, int z, block b)
+{
+    chunk_coord coord = chunk_of(x, y, z);
+    chunk *c = find_chunk(coord);
+    if (c == nullptr) {
+        if (b == block::air) {
+            return;
+        }
+        c = &get_or_create_chunk(coord);
+    }
+
+    bool changed = c->set(floor_mod(x, chunk::size),
+                          floor_mod(y, chunk::size),
+                          floor_mod(z, chunk::size),
+                          b);
+    if (!changed) {
+        return;
+    }
+
+    // A block on a section border also changes the faces and ambient
+    // occlusion of the sections across that border, including the ones
+    // only sharing an edge or corner with it.
+    int local[3] = {floor_mod(x, chunk::size),
+                    floor_mod(y, chunk::size),
+                    floor_mod(z, chunk::size)};
+    mark_sections_dirty(coord, border_sections(local[0], local[1], local[2]));
+    note_block_change(coord, chunk::index(local[0], local[1], local[2]));
+}
+
+chunk *world::find_chunk(const chunk_coord& coord)
+{
+    auto it = m_chunks.find(coord);
+    if (it == m_chunks.end()) {
+        return nullptr;
+    }
+
+    return it->second.get();
+}
+
+const chunk *world::find_chunk(const chunk_coord& coord) const
+{
+    auto it = m_chunks.find(coord);
+    if (it == m_chunks.end()) {
+        return nullptr;
+    }
+
+    return it->second.get();
+}
+
+chunk& world::get_or_create_chunk(const chunk_coord& coord)
+{
+    pooled_chunk& slot = m_chunks[coord];
+    if (!slot) {
+        slot = chunk_pool::shared().make();
+        note_new_chunk(coord);
+    }
+
+    return *slot;
+}
+
+void world::insert_chunk(const chunk_coord& coord, pooled_chunk c)
+{
+    m_chunks[coord] = move(c);
+    mark_chunk_dirty(coord);
+    note_new_chunk(coord);
+}
+
+chunk_handle world::handle_of(const chunk_coord& coord) const
+{
+    auto it = m_chunks.find(coord);
+    if (it == m_chunks.end()) {
+        return chunk_handle{0, 0};
+    }
+
+    return it->second.get_deleter().handle;
+}
+
+const world::chunk_map& world::chunks() const
+{
+    return m_chunks;
+}
+
+size_t world::chunk_count() const
+{
+    return m_chunks.size();
+}
+
+void world::mark_section_dirty(const section_coord& coord)
+{
+    m_dirty_sections.insert(coord);
+}
+
+void world::mark_chunk_dirty(const chunk_coord& coord)
+{
+    // Every section of the chunk, plus the ring of neighboring sections
+    // around it, since their border faces may now be hidden or exposed
+    // and their ambient occlusion reaches diagonally into this chunk.
+    int first[3] = {coord.x * chunk::sections,
+                    coord.y * chunk::sections,
+                    coord.z * chunk::sections};
+
+    for (int sy = -1; sy <= chunk::sections; sy++) {
+        for (int sz = -1; sz <= chunk::sections; sz++) {
+            for (int sx = -1; sx <= chunk::sections; sx++) {
+                mark_section_dirty(section_coord{first[0] + sx,
+                                                 first[1] + sy,
+                                                 first[2] + sz});
+            }
+        }
+    }
+}
+
+void world::mark_sections_dirty(const chunk_coord& coord, uint64_t mask)
+{
+    int span = chunk::sections + 2;
+    for (int bit = 0; bit < 64 && mask != 0; bit++) {
+        if ((mask & ((uint64_t)1 << bit)) == 0) {
+            continue;
+        }
+        mask &= ~((uint64_t)1 << bit);
+
+        int sx = bit % span - 1;
+        int sz = (bit / span) % span - 1;
+        int sy = bit / (span * span) - 1;
+        mark_section_dirty(section_coord{coord.x * chunk::sections + sx,
+                                         coord.y * chunk::sections + sy,
+                                         coord.z * chunk::sections + sz});
+    }
+}
+
+void world::take_dirty_sections(vector<section_coord>& out)
+{
+    out.insert(out.end(), m_dirty_sections.begin(), m_dirty_sections.end());
+    m_dirty_sections.clear();
+}
+
+void world::set_change_log(bool enabled)
+{
+    m_change_log = enabled;
+}
+
+void world::note_block_change(const chunk_coord& coord, int index)
+{
+    if (m_change_log) {
+        m_block_changes.push_back(block_change{coord, static_cast<uint16_t>(index)});
+    }
+}
+
+void world::take_block_changes(vector<block_change>& out)
+{
+    out.insert(out.end(), m_block_changes.begin(), m_block_changes.end());
+    m_block_changes.clear();
+}
+
+void world::take_new_chunks(vector<chunk_coord>& out)
+{
+    out.insert(out.end(), m_new_chunks.begin(), m_new_chunks.end());
+    m_new_chunks.clear();
+}
+
+void world::note_new_chunk(const chunk_coord& coord)
+{
+    if (m_change_log) {
+        m_new_chunks.push_back(coord);
+    }
+}
+
+chunk_coord world::chunk_of(int x, int y, int z)
+{
+    return chunk_coord{floor_div(x, chunk::size),
+                       floor_div(y, chunk::size),
+                       floor_div(z, chunk::size)};
+}
+
+section_coord world::section_of(int x, int y, int z)
+{
+    return section_coord{floor_div(x, chunk::section_size),
+                         floor_div(y, chunk::section_size),
+                         floor_div(z, chunk::section_size)};
+}
+
+chunk_coord world::chunk_of_section(const section_coord& coord)
+{
+    return chunk_coord{floor_div(coord.x, chunk::sections),
+                       floor_div(coord.y, chunk::sections),
+                       floor_div(coord.z, chunk::sections)};
+}
+
+uint64_t world::border_sections(int x, int y, int z)
+{
+    // Sections a change inside one chunk can dirty span one section past
+    // the chunk on each side, 4^3 in all; bit layout is y, z, x major to
+    // minor, offset by one.
+    static const int span = chunk::sections + 2;
+    static_assert(span * span * span <= 64,
+                  "dirty section mask must fit in 64 bits");
+
+    int local[3] = {x, y, z};
+    int s[3];
+    int reach[3];
+    for (int axis = 0; axis < 3; axis++) {
+        s[axis] = local[axis] / chunk::section_size;
+
+        int within = local[axis] % chunk::section_size;
+        if (within == 0) {
+            reach[axis] = -1;
+        } else if (within == chunk::section_size - 1) {
+            reach[axis] = 1;
+        } else {
+            reach[axis] = 0;
+        }
+    }
+
+    uint64_t mask = 0;
+    for (int dy = 0; dy <= 1; dy++) {
+        for (int dz = 0; dz <= 1; dz++) {
+            for (int dx = 0; dx <= 1; dx++) {
+                if ((dx && !reach[0]) || (dy && !reach[1]) || (dz && !reach[2])) {
+                    continue;
+                }
+                int sx = s[0] + dx * reach[0] + 1;
+                int sy = s[1] + dy * reach[1] + 1;
+                int sz = s[2] + dz * reach[2] + 1;
+                mask |= (uint64_t)1 << ((sy * span + sz) * span + sx);
+            }
+        }
+    }
+
+    return mask;
+}
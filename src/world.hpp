@@ -0,0 +1,87 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "chunk_pool.hpp"
+
+// C Standard Headers
+#include <cstdint>
+
+// C++ Standard Headers
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ *  A block that changed, by chunk and chunk::index() within it
+ */
+struct block_change {
+    chunk_coord coord;
+    uint16_t index;
+};
+
+/**
+ *  In-memory voxel world: a sparse map of loaded chunks
+ *
+ *  Chunks are allocated from the shared chunk_pool.  handle_of() gives a
+ *  reference that can be kept across frames and checked with
+ *  chunk_pool::get(), unlike the raw pointer from find_chunk().
+ *
+ *  Block coordinates are world-space integers; chunks that have not been
+ *  created read back as air.  Edits record which mesh sections they
+ *  invalidate, including the neighbor section when an edit lands on a
+ *  section border, so renderers only rebuild what actually changed.
+ *
+ *  With the change log enabled the world also records which blocks
+ *  changed and which chunks appeared, for systems such as lighting that
+ *  derive data from the blocks and update it incrementally.
+ */
+class world {
+ public:
+    typedef std::unordered_map<chunk_coord,
+                               pooled_chunk,
+                               chunk_coord_hash> chunk_map;
+
+    world();
+
+    block get_block(int x, int y, int z) const;
+    void set_block(int x, int y, int z, block b);
+
+    chunk *find_chunk(const chunk_coord& coord);
+    const chunk *find_chunk(const chunk_coord& coord) const;
+    chunk& get_or_create_chunk(const chunk_coord& coord);
+    void insert_chunk(const chunk_coord& coord, pooled_chunk c);
+    chunk_handle handle_of(const chunk_coord& coord) const;
+
+    const chunk_map& chunks() const;
+    size_t chunk_count() const;
+
+    void mark_section_dirty(const section_coord& coord);
+    void mark_chunk_dirty(const chunk_coord& coord);
+    void mark_sections_dirty(const chunk_coord& coord, uint64_t mask);
+    void take_dirty_sections(std::vector<section_coord>& out);
+
+    void set_change_log(bool enabled);
+    void note_block_change(const chunk_coord& coord, int index);
+    void take_block_changes(std::vector<block_change>& out);
+    void take_new_chunks(std::vector<chunk_coord>& out);
+
+    static chunk_coord chunk_of(int x, int y, int z);
+    static section_coord section_of(int x, int y, int z);
+    static chunk_coord chunk_of_section(const section_coord& coord);
+    static uint64_t border_sections(int x, int y, int z);
+
+ private:
+    void note_new_chunk(const chunk_coord& coord);
+
+    chunk_map m_chunks;
+    std::unordered_set<section_coord, chunk_coord_hash> m_dirty_sections;
+
+    bool m_change_log;
+    std::vector<block_change> m_block_changes;
+    std::vector<chunk_coord> m_new_chunks;
+};
+
+#endif // WORLD_HPP
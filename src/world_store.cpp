@@ -0,0 +1,118 @@
+// Module Header
+#include "world_store.hpp"
+
+// C Standard Headers
+#include <cstdio>
+
+// C++ Standard Headers
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *s_region_extension = ".vxr";
+
+world_store::world_store(const string& directory) :
+    m_directory(directory)
+{
+    filesystem::create_directories(m_directory);
+}
+
+bool world_store::load_chunk(const chunk_coord& coord, chunk& c)
+{
+    region_file& r = region(region_file::region_of(coord));
+    return r.read_chunk(region_file::slot_of(coord), c);
+}
+
+void world_store::save_chunk(const chunk_coord& coord, const chunk& c)
+{
+    region_file& r = region(region_file::region_of(coord));
+    r.write_chunk(region_file::slot_of(coord), c);
+}
+
+void world_store::saved_chunks(vector<chunk_coord>& out)
+{
+    for (const auto& file : filesystem::directory_iterator(m_directory)) {
+        if (file.path().extension() != s_region_extension) {
+            continue;
+        }
+
+        chunk_coord rc;
+        string stem = file.path().stem().string();
+        if (sscanf(stem.c_str(), "r.%d.%d.%d", &rc.x, &rc.y, &rc.z) != 3) {
+            continue;
+        }
+
+        region_file& r = region(rc);
+        for (int slot = 0; slot < region_file::slot_count; slot++) {
+            if (r.contains(slot)) {
+                out.push_back(region_file::chunk_at(rc, slot));
+            }
+        }
+    }
+}
+
+void world_store::load(world& w)
+{
+    vector<chunk_coord> coords;
+    saved_chunks(coords);
+
+    for (const chunk_coord& coord : coords) {
+        pooled_chunk c = chunk_pool::shared().make();
+        load_chunk(coord, *c);
+        w.insert_chunk(coord, move(c));
+    }
+}
+
+void world_store::save(world& w)
+{
+    for (const auto& entry : w.chunks()) {
+        chunk& c = *entry.second;
+        if (!c.needs_save()) {
+            continue;
+        }
+
+        save_chunk(entry.first, c);
+        c.mark_saved();
+    }
+
+    for (auto& entry : m_regions) {
+        if (entry.second->wants_compaction()) {
+            entry.second->compact();
+        }
+    }
+}
+
+region_file& world_store::region(const chunk_coord& region_coord)
+{
+    lock_guard<mutex> lock(m_regions_mutex);
+
+    auto it = m_regions.find(region_coord);
+    if (it != m_regions.end()) {
+        return *it->second;
+    }
+
+    // Open before inserting so a corrupt file doesn't leave a null entry
+    auto r = make_unique<region_file>(region_path(region_coord));
+    region_file& result = *r;
+    m_regions.emplace(region_coord, move(r));
+    return result;
+}
+
+const string& world_store::directory() const
+{
+    return m_directory;
+}
+
+string world_store::region_path(const chunk_coord& region_coord) const
+{
+    char name[64];
+    snprintf(name, sizeof(name), "r.%d.%d.%d%s",
+             region_coord.x, region_coord.y, region_coord.z,
+             s_region_extension);
+
+    return m_directory + "/" + name;
+}
@@ -0,0 +1,50 @@
+#ifndef WORLD_STORE_HPP
+#define WORLD_STORE_HPP
+
+// Local Headers
+#include "chunk.hpp"
+#include "region_file.hpp"
+#include "world.hpp"
+
+// C++ Standard Headers
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ *  Persists a world as a directory of region files
+ *
+ *  Region files are opened on first use and kept open (and mapped) for
+ *  the lifetime of the store, so random chunk loads after the first touch
+ *  of a region cost one table lookup and a decode.
+ *
+ *  region() may be called from several threads, but each region_file
+ *  must only be used by one thread at a time (see chunk_io).
+ */
+class world_store {
+ public:
+    explicit world_store(const std::string& directory);
+
+    bool load_chunk(const chunk_coord& coord, chunk& c);
+    void save_chunk(const chunk_coord& coord, const chunk& c);
+
+    void saved_chunks(std::vector<chunk_coord>& out);
+    void load(world& w);
+    void save(world& w);
+
+    region_file& region(const chunk_coord& region_coord);
+    const std::string& directory() const;
+
+ private:
+    std::string region_path(const chunk_coord& region_coord) const;
+
+    std::string m_directory;
+    std::mutex m_regions_mutex;
+    std::unordered_map<chunk_coord,
+                       std::unique_ptr<region_file>,
+                       chunk_coord_hash> m_regions;
+};
+
+#endif // WORLD_STORE_HPP
@@ -0,0 +1,67 @@
+// Shading shared by the terrain shaders, included after the defines
+
+// Light level (0 to 1) to brightness, never quite black
+float light_curve(float level)
+{
+    return 0.05f + 0.95f * level * level;
+}
+
+// Baked ambient occlusion level, 0 (enclosed corner) to 3 (open)
+float ao_factor(float ao)
+{
+    return 0.4f + 0.2f * ao;
+}
+
+// Fog fades to the clear colour (see gl_wrapper::clear_screen) towards
+// the far plane
+const vec3 fog_color = vec3(0.2f, 0.3f, 0.3f);
+const float fog_start = 40.0f;
+const float fog_end = 95.0f;
+
+float fog_factor(float view_distance)
+{
+    return clamp((view_distance - fog_start) / (fog_end - fog_start), 0.0f, 1.0f);
+}
+
+#ifdef SHADOWS
+// Must match shadow_cascades::cascade_count
+const int cascade_count = 3;
+
+// Cascades nearest first, each ending at view depth cascade_far; see
+// shadow_cascades.hpp
+uniform sampler2DArrayShadow shadow_map;
+uniform mat4 shadow_matrix[cascade_count];
+uniform float cascade_far[cascade_count];
+uniform float shadow_texel[cascade_count];
+uniform vec3 sun_direction;
+
+// Share of the light taken away in full shadow; sky light still reaches
+const float shadow_strength = 0.45f;
+
+// Lookups move this many shadow texels out along the face normal, so a
+// lit face does not shadow itself
+const float shadow_normal_offset = 1.5f;
+
+// 1 where the sun reaches the surface and 0 in shadow, soft at the edges
+// from the filtered comparison.  Faces turned away from the sun are in
+// their own shadow.  Outside every cascade counts as lit.
+float sun_visibility(vec3 world_position, vec3 normal, float view_depth)
+{
+    if (dot(normal, sun_direction) >= 0.0f) {
+        return 0.0f;
+    }
+
+    for (int i = 0; i < cascade_count; i++) {
+        if (view_depth > cascade_far[i]) {
+            continue;
+        }
+
+        vec3 offset = normal * shadow_texel[i] * shadow_normal_offset;
+        vec3 p = (shadow_matrix[i] * vec4(world_position + offset, 1.0f)).xyz * 0.5f + 0.5f;
+        if (all(greaterThan(p.xy, vec2(0.0f))) && all(lessThan(p.xy, vec2(1.0f)))) {
+            return texture(shadow_map, vec4(p.xy, float(i), p.z));
+        }
+    }
+    return 1.0f;
+}
+#endif